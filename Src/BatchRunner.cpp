@@ -0,0 +1,136 @@
+#include "BatchRunner.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSet>
+#include <QTextStream>
+#include <QThread>
+
+#include <algorithm>
+#include <iostream>
+
+BatchRunner::BatchRunner(QObject *parent, Config *cfg) :
+	QObject(parent),
+	_cfg(cfg),
+	m_Next(0),
+	m_MaxJobs(1) {
+
+	QObject::connect(&m_Jobs, &ProcessJobs::jobFinished, this, &BatchRunner::jobFinished);
+	QObject::connect(&m_ProgressTimer, &QTimer::timeout, this, &BatchRunner::printProgress);
+}
+
+QStringList BatchRunner::expandInput(const QString &input) {
+	QStringList videos;
+	QFileInfo fi(input);
+
+	// Wildcards are only expanded in the file name
+	if (fi.fileName().contains(QRegularExpression("[*?\\[]"))) {
+		QDir dir = fi.dir();
+		for (const QString &name : dir.entryList(QStringList{ fi.fileName() }, QDir::Files, QDir::Name)) {
+			videos << dir.absoluteFilePath(name);
+		}
+	}
+	else if (fi.suffix() == "txt" || fi.suffix() == "lst") {
+		QFile file(input);
+		if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+			QTextStream ts(&file);
+			while (!ts.atEnd()) {
+				const QString line = ts.readLine().trimmed();
+				if (line.isEmpty() || line.startsWith('#'))
+					continue;
+				// Relative paths are relative to the list
+				videos << QFileInfo(fi.dir(), line).absoluteFilePath();
+			}
+		}
+		else {
+			std::cout << "Could not read " << input.toStdString() << std::endl;
+		}
+	}
+	else {
+		videos << fi.absoluteFilePath();
+	}
+	return videos;
+}
+
+bool BatchRunner::start(const QStringList &inputs) {
+	if (_cfg->UsePlugins.isEmpty()) {
+		std::cout << "--batch needs a plugin, use --usePlugin" << std::endl;
+		return false;
+	}
+
+	QStringList videos;
+	for (const QString &input : inputs) {
+		videos << expandInput(input);
+	}
+	if (videos.isEmpty()) {
+		std::cout << "No videos to track" << std::endl;
+		return false;
+	}
+
+	QDir exportDir(_cfg->ExportPath.isEmpty() ? _cfg->DirTracks : _cfg->ExportPath);
+	exportDir.mkpath(".");
+
+	// Videos of the same name from different directories get numbered exports
+	QSet<QString> names;
+	for (const QString &video : videos) {
+		QString name = QFileInfo(video).completeBaseName();
+		for (int i = 2; names.contains(name); i++) {
+			name = QFileInfo(video).completeBaseName() + "_" + QString::number(i);
+		}
+		names.insert(name);
+
+		m_Jobs.add(video, exportDir.absoluteFilePath(name), exportDir.absoluteFilePath(name + ".log"));
+	}
+
+	// Every job runs a decoding and a tracking thread
+	m_MaxJobs = _cfg->BatchJobs > 0 ? _cfg->BatchJobs : std::max(1, QThread::idealThreadCount() / 2);
+	std::cout << "Tracking " << m_Jobs.size() << " videos, " << m_MaxJobs << " at once, exports in "
+		<< exportDir.absolutePath().toStdString() << std::endl;
+
+	m_Begin = std::chrono::steady_clock::now();
+	launchJobs();
+	m_ProgressTimer.start(10000);
+	return true;
+}
+
+void BatchRunner::launchJobs() {
+	while (m_Next < m_Jobs.size() && m_Jobs.running() < static_cast<size_t>(m_MaxJobs)) {
+		const size_t index = m_Next++;
+		const ProcessJobs::Job &job = m_Jobs.job(index);
+
+		QStringList arguments{ "--headless", "--usePlugin", _cfg->UsePlugins, "--video", job.name, "--export", job.exportPath };
+		if (!_cfg->CfgCustomLocation.isEmpty()) {
+			arguments << "--cfg" << _cfg->CfgCustomLocation;
+		}
+		m_Jobs.launch(index, arguments);
+	}
+}
+
+void BatchRunner::jobFinished(size_t) {
+	launchJobs();
+	if (m_Jobs.done() == m_Jobs.size()) {
+		m_ProgressTimer.stop();
+		printSummary();
+	}
+}
+
+void BatchRunner::printProgress() {
+	const size_t frames = m_Jobs.frames();
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_Begin).count();
+	std::cout << "Batch: " << m_Jobs.done() << "/" << m_Jobs.size() << " done (" << m_Jobs.failed() << " failed), " << m_Jobs.running() << " running, "
+		<< frames << " frames, " << (seconds > 0 ? frames / seconds : 0) << " fps" << std::endl;
+}
+
+void BatchRunner::printSummary() {
+	const size_t failed = m_Jobs.failed();
+	const size_t frames = m_Jobs.frames();
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_Begin).count();
+
+	std::cout << std::endl << "Batch finished: " << m_Jobs.size() - failed << " of " << m_Jobs.size() << " videos tracked, "
+		<< frames << " frames in " << seconds << " s (" << (seconds > 0 ? frames / seconds : 0) << " fps)" << std::endl;
+	m_Jobs.printResults();
+
+	Q_EMIT finished(failed ? 1 : 0);
+}
@@ -0,0 +1,57 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+
+#include "ProcessJobs.h"
+#include "util/Config.h"
+
+#include <chrono>
+
+/**
+ * The BatchRunner tracks many videos in parallel. Every video is a job running in its own BioTracker process in
+ * headless mode, so each job has its own ImageStream, plugin instance and exporter (plugins are singletons within a process).
+ * BatchJobs jobs run at once, the output of each job goes to a log file next to its export.
+ */
+class BatchRunner : public QObject {
+	Q_OBJECT
+public:
+	BatchRunner(QObject *parent = 0, Config *cfg = nullptr);
+
+	/**
+	 * Expands inputs (video files, globs and text files listing one video per line) and starts the first jobs.
+	 * @return false if there is no video to track
+	 */
+	bool start(const QStringList &inputs);
+
+	/**
+	 * @return the videos given by input, see start
+	 */
+	static QStringList expandInput(const QString &input);
+
+Q_SIGNALS:
+	/**
+	 * All jobs are done, exitCode is 0 if every job succeeded.
+	 */
+	void finished(int exitCode);
+
+private Q_SLOTS:
+	void printProgress();
+
+private:
+	void launchJobs();
+	void jobFinished(size_t index);
+	void printSummary();
+
+	Config *_cfg;
+	// One job per video
+	ProcessJobs m_Jobs;
+	size_t m_Next;
+	int m_MaxJobs;
+	QTimer m_ProgressTimer;
+	std::chrono::steady_clock::time_point m_Begin;
+};
+
+#endif // BATCHRUNNER_H
@@ -142,6 +142,10 @@ void ControllerAreaDescriptor::connectControllerToController()
         auto parmsController = qobject_cast<ControllerCoreParameter*>(ctrParms);
         QObject::connect(this, &ControllerAreaDescriptor::changeAreaDescriptorType, parmsController, &ControllerCoreParameter::changeAreaDescriptorType, Qt::DirectConnection);
 
+        //The tracker may only receive the bounding box of the tracking area
+        QObject::connect(this, &ControllerAreaDescriptor::emitCropRegion, player, &MediaPlayer::cropRegion);
+        updateCropRegion();
+
 
 		AreaInfo* area = dynamic_cast<AreaInfo*>(getModel());
 		QObject::connect(area->_rect.get(), SIGNAL(updatedVertices()), this, SLOT(updateView()));
@@ -173,6 +177,28 @@ void ControllerAreaDescriptor::updateView() {
 	ad->updateRect();
 	area->updateRectification();
 	area->updateApperture();
+	updateCropRegion();
+}
+
+void ControllerAreaDescriptor::setCropToAperture(bool crop) {
+	_cropToAperture = crop;
+	updateCropRegion();
+}
+
+void ControllerAreaDescriptor::updateCropRegion() {
+	QRect region;
+	if (_cropToAperture) {
+		AreaInfo* area = static_cast<AreaInfo*>(getModel());
+		std::vector<cv::Point> vertices = area->_apperture->getVertices();
+		if (!vertices.empty()) {
+			cv::Rect r = cv::boundingRect(vertices);
+			region = QRect(r.x, r.y, r.width, r.height);
+		}
+	}
+	if (region != _cropRegion) {
+		_cropRegion = region;
+		Q_EMIT emitCropRegion(region);
+	}
 }
 
 
@@ -4,6 +4,7 @@
 #include "Interfaces/IModel/IModelAreaDescriptor.h"
 #include <QMouseEvent>
 #include <QKeyEvent>
+#include <QRect>
 #include "util/types.h"
 #include "Model/MediaPlayerStateMachine/PlayerParameters.h"
 
@@ -14,11 +15,17 @@ public:
 	ControllerAreaDescriptor(QObject *parent = 0, IBioTrackerContext *context = 0, ENUMS::CONTROLLERTYPE ctr = ENUMS::CONTROLLERTYPE::AREADESCRIPTOR);
 
 	void triggerUpdateAreaDescriptor();
+	/**
+	 * Hands the tracker only the bounding box of the tracking area. Plugins ask for it with the "croppedFrames"
+	 * property, they map their results back to full frame coordinates with cv::Mat::locateROI.
+	 */
+	void setCropToAperture(bool crop);
 
 signals:
 	void updateAreaDescriptor(IModelAreaDescriptor *ad);
     void currentVectorDrag(BiotrackerTypes::AreaType vectorType, int id, double x, double y);
     void changeAreaDescriptorType(QString type);
+    void emitCropRegion(QRect region);
 
 public slots:
 	void setRectificationDimensions(double w, double h);
@@ -35,6 +42,7 @@ private slots:
 	void mouseMoveEvent(QMouseEvent*event, const QPoint &pos);
 	void keyReleaseEvent(QKeyEvent *event);
 	void updateView();
+	void updateCropRegion();
 
 	// IController interface
 protected:
@@ -52,4 +60,6 @@ private:
     bool _visibleApperture = false;
     bool _visibleRectification = false;
     QString _currentFilename = "No Media";
+    QRect _cropRegion;
+    bool _cropToAperture = false;
 };
\ No newline at end of file
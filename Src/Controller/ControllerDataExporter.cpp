@@ -5,6 +5,7 @@
 #include "Model/DataExporters/DataExporterCSV.h"
 #include "Model/DataExporters/DataExporterSerialize.h"
 #include "Model/DataExporters/DataExporterJson.h"
+#include "Model/LatencyTracer.h"
 #include "util/types.h"
 #include <qmessagebox.h>
 #include "QDesktopServices"
@@ -47,12 +48,27 @@ void ControllerDataExporter::createModel() {
     m_Model = nullptr;
 }
 
+void ControllerDataExporter::setSource(std::string name, double fps) {
+	_sourceName = name;
+	_sourceFps = fps;
+}
+
+void ControllerDataExporter::setExportPath(QString path) {
+	_exportPath = path;
+}
+
 SourceVideoMetadata ControllerDataExporter::getSourceMetadata() {
-	IController* ctrM = m_BioTrackerContext->requestController(ENUMS::CONTROLLERTYPE::PLAYER);
-	MediaPlayer* mplay = dynamic_cast<MediaPlayer*>(ctrM->getModel());
 	SourceVideoMetadata d;
-	d.name = mplay->getCurrentFileName().toStdString();
-	d.fps = std::to_string(mplay->getFpsOfSourceFile());
+	double fps = _sourceFps;
+	d.name = _sourceName;
+	// Without a context (headless) there is no player, the source is given by setSource
+	if (m_BioTrackerContext) {
+		IController* ctrM = m_BioTrackerContext->requestController(ENUMS::CONTROLLERTYPE::PLAYER);
+		MediaPlayer* mplay = dynamic_cast<MediaPlayer*>(ctrM->getModel());
+		d.name = mplay->getCurrentFileName().toStdString();
+		fps = mplay->getFpsOfSourceFile();
+	}
+	d.fps = std::to_string(fps);
 	d.fps = d.fps.erase(d.fps.find_last_not_of('0') + 1, std::string::npos);
 	return d;
 }
@@ -109,8 +125,11 @@ void ControllerDataExporter::setComponentFactory(IModelTrackedComponentFactory*
 }
 
 void ControllerDataExporter::receiveTrackingDone(uint frame) {
+    BioTracker::Core::LatencyTracer &tracer = BioTracker::Core::LatencyTracer::instance();
+    tracer.stamp(frame, BioTracker::Core::FrameDescriptor::TrackingDone);
     if (getModel()) {
         dynamic_cast<IModelDataExporter*>(getModel())->write(frame);
+        tracer.stamp(frame, BioTracker::Core::FrameDescriptor::Exported);
     }
 }
 
@@ -164,6 +183,12 @@ int ControllerDataExporter::getNumber(bool trial) {
 
 QString ControllerDataExporter::generateBasename(bool temporaryFile) {
 
+    // The exporters append their own suffix
+    if (!temporaryFile && !_exportPath.isEmpty()) {
+        QFileInfo fi(_exportPath);
+        return fi.suffix().isEmpty() ? fi.absoluteFilePath() : fi.absolutePath() + "/" + fi.completeBaseName();
+    }
+
 	QString resultPath = (_trialStarted ?_cfg->DirTrials : _cfg->DirTracks);
 
     QString path = (temporaryFile ? _cfg->DirTemp : resultPath);
@@ -175,6 +200,11 @@ QString ControllerDataExporter::generateBasename(bool temporaryFile) {
 
 void ControllerDataExporter::receiveFileWritten(QFileInfo fname) {
 
+    if (_cfg->Headless) {
+        std::cout << "Exported file: " << fname.absoluteFilePath().toStdString() << std::endl;
+        return;
+    }
+
     QString str = "Exported file:\n";
     str += fname.absoluteFilePath();
 
@@ -27,6 +27,14 @@ public:
 	void setComponentFactory(IModelTrackedComponentFactory* exp);
 	IModelTrackedComponentFactory* getComponentFactory() { return _factory; };
 	SourceVideoMetadata getSourceMetadata();
+	/**
+	 * Source metadata used if there is no player to ask, e.g. in headless mode.
+	 */
+	void setSource(std::string name, double fps);
+	/**
+	 * Writes the export to path instead of a new file in the tracks directory. A suffix of path is replaced by the one of the exporter.
+	 */
+	void setExportPath(QString path);
     int getNumber(bool trial);
     QString generateBasename(bool temporaryFile);
 
@@ -55,5 +63,8 @@ private Q_SLOTS:
 private:
 	IModelTrackedComponentFactory* _factory;
 	bool _trialStarted = false;
+	std::string _sourceName;
+	double _sourceFps = 0;
+	QString _exportPath;
 };
 
@@ -15,6 +15,7 @@
 #include "GuiContext.h"
 
 #include "QPluginLoader"
+#include "QDebug"
 
 #include <chrono>
 #include <thread>
@@ -64,6 +65,42 @@ void ControllerMainWindow::loadCameraDevice(CameraConfiguration conf) {
     dynamic_cast<MainWindow*>(m_View)->checkMediaGroupBox();
 }
 
+void ControllerMainWindow::loadSynthetic(BioTracker::Core::SyntheticConfiguration conf) {
+    Q_EMIT emitOnLoadMedia("::Synthetic");
+    IController* ctr = m_BioTrackerContext->requestController(ENUMS::CONTROLLERTYPE::PLAYER);
+    qobject_cast<ControllerPlayer*>(ctr)->loadSynthetic(conf);
+    Q_EMIT emitMediaLoaded("::Synthetic");
+
+    dynamic_cast<MainWindow*>(m_View)->checkMediaGroupBox();
+}
+
+void ControllerMainWindow::loadDirectory(boost::filesystem::path directory) {
+    Q_EMIT emitOnLoadMedia(directory.string());
+    IController* ctr = m_BioTrackerContext->requestController(ENUMS::CONTROLLERTYPE::PLAYER);
+    qobject_cast<ControllerPlayer*>(ctr)->loadDirectory(directory);
+    Q_EMIT emitMediaLoaded(directory.string());
+
+    dynamic_cast<MainWindow*>(m_View)->checkMediaGroupBox();
+}
+
+void ControllerMainWindow::loadPipe(boost::filesystem::path pipe) {
+    Q_EMIT emitOnLoadMedia(pipe.string());
+    IController* ctr = m_BioTrackerContext->requestController(ENUMS::CONTROLLERTYPE::PLAYER);
+    qobject_cast<ControllerPlayer*>(ctr)->loadPipe(pipe);
+    Q_EMIT emitMediaLoaded(pipe.string());
+
+    dynamic_cast<MainWindow*>(m_View)->checkMediaGroupBox();
+}
+
+void ControllerMainWindow::loadSharedMemory(QString name) {
+    Q_EMIT emitOnLoadMedia(name.toStdString());
+    IController* ctr = m_BioTrackerContext->requestController(ENUMS::CONTROLLERTYPE::PLAYER);
+    qobject_cast<ControllerPlayer*>(ctr)->loadSharedMemory(name);
+    Q_EMIT emitMediaLoaded(name.toStdString());
+
+    dynamic_cast<MainWindow*>(m_View)->checkMediaGroupBox();
+}
+
 void ControllerMainWindow::activeTracking() {
     IController* ctr = m_BioTrackerContext->requestController(ENUMS::CONTROLLERTYPE::PLAYER);
     qobject_cast<ControllerPlayer*>(ctr)->setTrackingActivated();
@@ -215,6 +252,20 @@ void ControllerMainWindow::connectControllerToController() {
 	//Load video as per CLI
     if (!_cfg->LoadVideo.isEmpty()) 
         loadVideo({ _cfg->LoadVideo.toStdString().c_str() });
+    else if (!_cfg->LoadSharedMemory.isEmpty())
+        loadSharedMemory(_cfg->LoadSharedMemory);
+    else if (!_cfg->LoadPipe.isEmpty())
+        loadPipe(_cfg->LoadPipe.toStdString());
+    else if (!_cfg->WatchDirectory.isEmpty())
+        loadDirectory(_cfg->WatchDirectory.toStdString());
+    else if (!_cfg->LoadSynthetic.isEmpty()) {
+        try {
+            loadSynthetic(BioTracker::Core::SyntheticConfiguration::parse(_cfg->LoadSynthetic.toStdString()));
+        }
+        catch (const std::invalid_argument &e) {
+            qWarning() << e.what();
+        }
+    }
 }
 
 void ControllerMainWindow::receiveCursorPosition(QPoint pos)
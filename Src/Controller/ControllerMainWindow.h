@@ -15,6 +15,7 @@
 #include <vector>
 #include "util/types.h"
 #include "util/camera/base.h"
+#include "Model/SyntheticScene.h"
 
   /**
    * The ControllerMainWindow class controlls the IView class MainWindow.
@@ -42,6 +43,22 @@ public:
 	 * Receives the a string containing the camera device number from the MainWindow class. The string is then given to the ControllerPlayer class of the MediaPlayer-Component.
 	 */
 	void loadCameraDevice(CameraConfiguration conf);
+	/**
+	 * Loads a synthetic scene (see SyntheticScene.h), e.g. to benchmark the pipeline. The parameters are given to the ControllerPlayer class of the MediaPlayer-Component.
+	 */
+	void loadSynthetic(BioTracker::Core::SyntheticConfiguration conf);
+	/**
+	 * Receives the path of a directory which external capture software writes images to. The path is then given to the ControllerPlayer class of the MediaPlayer-Component.
+	 */
+	void loadDirectory(boost::filesystem::path directory);
+	/**
+	 * Receives the path of a pipe (or "-" for stdin) providing raw frames. The path is then given to the ControllerPlayer class of the MediaPlayer-Component.
+	 */
+	void loadPipe(boost::filesystem::path pipe);
+	/**
+	 * Receives the name of a shared memory frame ring filled by another process. The name is then given to the ControllerPlayer class of the MediaPlayer-Component.
+	 */
+	void loadSharedMemory(QString name);
 	/**
 	 * Receives a QStringListModel with the names of all currently loades BioTracker Plugins from the ControllerPlugin class.
 	 */
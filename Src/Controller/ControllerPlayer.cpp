@@ -7,6 +7,10 @@
 #include "Controller/ControllerTrackedComponentCore.h"
 #include "Controller/ControllerCoreParameter.h"
 
+#include "View/GraphicsView.h"
+
+#include <cmath>
+
 #include <QGraphicsItem>
 #include <QToolButton>
 
@@ -34,6 +38,26 @@ void ControllerPlayer::loadCameraDevice(CameraConfiguration conf) {
 	emitPauseState(true);
 }
 
+void ControllerPlayer::loadSynthetic(BioTracker::Core::SyntheticConfiguration conf) {
+    qobject_cast<MediaPlayer*>(m_Model)->loadSynthetic(conf);
+	emitPauseState(true);
+}
+
+void ControllerPlayer::loadDirectory(boost::filesystem::path directory) {
+    qobject_cast<MediaPlayer*>(m_Model)->loadDirectory(directory);
+	emitPauseState(true);
+}
+
+void ControllerPlayer::loadPipe(boost::filesystem::path pipe) {
+    qobject_cast<MediaPlayer*>(m_Model)->loadPipe(pipe);
+	emitPauseState(true);
+}
+
+void ControllerPlayer::loadSharedMemory(QString name) {
+    qobject_cast<MediaPlayer*>(m_Model)->loadSharedMemory(name);
+	emitPauseState(true);
+}
+
 void ControllerPlayer::nextFrame() {
     qobject_cast<MediaPlayer*>(m_Model)->nextFrameCommand();
 }
@@ -61,18 +85,34 @@ void ControllerPlayer::setGoToFrame(int frame) {
     qobject_cast<MediaPlayer*>(m_Model)->goToFrame(frame);
 }
 
-void ControllerPlayer::receiveRenderImage(std::shared_ptr<cv::Mat> mat, QString name) {
+void ControllerPlayer::receiveRenderImage(std::shared_ptr<cv::Mat> mat, QString name, QSize sourceSize) {
     IController* ctr = m_BioTrackerContext->requestController(ENUMS::CONTROLLERTYPE::TEXTUREOBJECT);
     QPointer< ControllerTextureObject > ctrTextureObject = qobject_cast<ControllerTextureObject*>(ctr);
 
-    ctrTextureObject->receiveCvMat(mat, name);
+    ctrTextureObject->receiveCvMat(mat, name, sourceSize);
+
+    if (_cfg->DisplayPreview) {
+        IController* ctrGV = m_BioTrackerContext->requestController(ENUMS::CONTROLLERTYPE::GRAPHICSVIEW);
+        GraphicsView* view = dynamic_cast<GraphicsView*>(qobject_cast<ControllerGraphicScene*>(ctrGV)->getView());
+
+        // screen pixels per frame pixel, in steps of 1/8 so zooming does not change the preview size every frame
+        const double zoom = view->transform().m11() * view->devicePixelRatioF();
+        const double scale = zoom >= 1.0 ? 1.0 : std::ceil(zoom * 8.0) / 8.0;
+        if (scale != _previewScale) {
+            _previewScale = scale;
+            Q_EMIT qobject_cast<MediaPlayer*>(m_Model)->previewScale(scale);
+        }
+    }
 }
 
 void ControllerPlayer::receiveImageToTracker(std::shared_ptr<cv::Mat> mat, uint number) {
     IController* ctr = m_BioTrackerContext->requestController(ENUMS::CONTROLLERTYPE::PLUGIN);
     QPointer< ControllerPlugin > ctrPlugin = qobject_cast<ControllerPlugin*>(ctr);
 
-    ctrPlugin->sendCurrentFrameToPlugin(mat, number);
+    // Without a plugin nobody reports the frame as done
+    if (!ctrPlugin->sendCurrentFrameToPlugin(mat, number)) {
+        receiveFrameTracked(number);
+    }
 }
 
 void ControllerPlayer::changeImageView(QString str) {
@@ -184,6 +224,10 @@ void ControllerPlayer::receiveVisualizeCurrentModel(uint frameNumber)
 	ctrTrCompCore->receiveVisualizeTrackingModel(frameNumber);
 }
 
+void ControllerPlayer::receiveFrameTracked(uint frameNumber) {
+    qobject_cast<MediaPlayer*>(m_Model)->receiveFrameTracked(frameNumber);
+}
+
 void ControllerPlayer::receiveChangeDisplayImage(QString str) {
 
 	VideoControllWidget *w = dynamic_cast<VideoControllWidget*>(m_View);
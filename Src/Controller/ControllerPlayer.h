@@ -33,6 +33,22 @@ class ControllerPlayer : public IControllerCfg {
 		* Hands over the camera device number to the IModel class MediaPlayer.
 		*/
 		void loadCameraDevice(CameraConfiguration conf);
+		/**
+		* Hands over the parameters of a synthetic scene to the IModel class MediaPlayer.
+		*/
+		void loadSynthetic(BioTracker::Core::SyntheticConfiguration conf);
+		/**
+		* Hands over the path of a directory to watch for new images to the IModel class MediaPlayer.
+		*/
+		void loadDirectory(boost::filesystem::path directory);
+		/**
+		* Hands over the path of a pipe to read raw frames from to the IModel class MediaPlayer.
+		*/
+		void loadPipe(boost::filesystem::path pipe);
+		/**
+		* Hands over the name of a shared memory frame ring to the IModel class MediaPlayer.
+		*/
+		void loadSharedMemory(QString name);
 
 		/**
 		* Tells the MediaPlayer-Component to hand over the current cv::Mat and the current frame number to the BioTracker Plugin.
@@ -92,8 +108,9 @@ class ControllerPlayer : public IControllerCfg {
 	public Q_SLOTS:
 		/**
 		* This SLOT receives a cv::Mat and a name for the cv::Mat from the MediaPlayer class and hands it over to the ControllerTextureObject for rendering.
+		* If previews are enabled, it also tells the MediaPlayer at which scale the GraphicsView currently shows the frames.
 		*/
-		void receiveRenderImage(std::shared_ptr<cv::Mat> mat, QString name);
+		void receiveRenderImage(std::shared_ptr<cv::Mat> mat, QString name, QSize sourceSize);
 		/**
 		* This SLOT receives a cv::Mat and its frame number and hands it over to the ControllerPlugin for Tracking in the BioTracker Plugin.
 		*/
@@ -102,6 +119,10 @@ class ControllerPlayer : public IControllerCfg {
 		* This SLOT receives a framenumber and hands it over to the ControllerTrackedComponentCore for visualizing in the main app.
 		*/
 		void receiveVisualizeCurrentModel(uint frameNumber);
+		/**
+		* This SLOT receives the frame number of a frame the tracker is done with, in hand-off order, and lets the MediaPlayer render that frame.
+		*/
+		void receiveFrameTracked(uint frameNumber);
 
 		void receiveChangeDisplayImage(QString str);
 
@@ -124,6 +145,7 @@ class ControllerPlayer : public IControllerCfg {
 	private:
 		int _trackCount = 0;
 		int _trackCountEndOfBatch = 0;
+		double _previewScale = 1.0;
 };
 
 #endif // CONTROLLERPLAYER_H
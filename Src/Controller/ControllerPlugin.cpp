@@ -84,6 +84,22 @@ void ControllerPlugin::loadPluginFromFileName(QString str) {
 		ctrDataExp->setComponentFactory(m_BioTrackerPlugin->getComponentFactory());
 
 		m_BioTrackerPlugin->sendCorePermissions();
+
+		// Plugins tracking on single channel frames ask for them with the "grayscaleFrames" property
+		QObject* obj = dynamic_cast<QObject*>(m_BioTrackerPlugin);
+		const bool grayscale = _cfg->TrackingGrayscale || (obj && obj->property("grayscaleFrames").toBool());
+		IController* ctrP = m_BioTrackerContext->requestController(ENUMS::CONTROLLERTYPE::PLAYER);
+		MediaPlayer* player = static_cast<MediaPlayer*>(static_cast<ControllerPlayer*>(ctrP)->getModel());
+		Q_EMIT player->trackingGrayscale(grayscale);
+
+		// Only plugins that map cropped frames back to full frame coordinates get them, others track on full frames
+		IController* ctrAD = m_BioTrackerContext->requestController(ENUMS::CONTROLLERTYPE::AREADESCRIPTOR);
+		qobject_cast<ControllerAreaDescriptor*>(ctrAD)->setCropToAperture(obj && obj->property("croppedFrames").toBool());
+
+		// Plugins reporting each tracked frame declare it with the "emitsTrackingDone" property, only then the
+		// player holds frames back for the tracker: waiting for a plugin that never reports would stall the player
+		m_emitsTrackingDone = obj && obj->property("emitsTrackingDone").toBool();
+		player->setTrackingPipeline(m_emitsTrackingDone);
 	}else{
 		qWarning() << "Failed to load plugin from filename!";
 	}
@@ -234,13 +250,16 @@ void ControllerPlugin::connectPlugin() {
 
 	QObject* obj = dynamic_cast<QObject*>(m_BioTrackerPlugin);
 
-	QObject::connect(obj, SIGNAL(emitTrackingDone(uint)), ctDataEx, SLOT(receiveTrackingDone(uint)));
+	// Results are forwarded to the player first:
+	// the player renders the tracked frame before the exporter and the view see the tracking model of that frame
+	QObject::connect(obj, SIGNAL(emitTrackingDone(uint)), this, SLOT(receiveTrackingDone(uint)));
+	QObject::connect(this, SIGNAL(emitTrackingDone(uint)), ctrPlayer, SLOT(receiveFrameTracked(uint)), Qt::UniqueConnection);
+	QObject::connect(this, SIGNAL(emitTrackingDone(uint)), ctDataEx, SLOT(receiveTrackingDone(uint)), Qt::UniqueConnection);
+	QObject::connect(this, SIGNAL(emitTrackingDone(uint)), ctrCompView, SLOT(receiveVisualizeTrackingModel(uint)), Qt::UniqueConnection);
 
 	QObject::connect(obj, SIGNAL(emitCvMat(std::shared_ptr<cv::Mat>, QString)),
 		ctrTexture, SLOT(receiveCvMat(std::shared_ptr<cv::Mat>, QString)));
 
-	QObject::connect(obj, SIGNAL(emitTrackingDone(uint)), ctrCompView, SLOT(receiveVisualizeTrackingModel(uint)));
-
 	QObject::connect(obj, SIGNAL(emitChangeDisplayImage(QString)), ctrPlayer, SLOT(receiveChangeDisplayImage(QString)));
 
 	QObject::connect(ctAreaDesc, SIGNAL(updateAreaDescriptor(IModelAreaDescriptor*)), obj, SLOT(receiveAreaDescriptor(IModelAreaDescriptor*)));
@@ -290,7 +309,7 @@ void ControllerPlugin::disconnectPlugin() {
 }
 
 //first send all the commands currently in the command queue then the next image can be sent
-void ControllerPlugin::sendCurrentFrameToPlugin(std::shared_ptr<cv::Mat> mat, uint number) {
+bool ControllerPlugin::sendCurrentFrameToPlugin(std::shared_ptr<cv::Mat> mat, uint number) {
 	m_currentFrameNumber = number;
 
 	//Prevent calling the plugin if none is loaded
@@ -333,7 +352,9 @@ void ControllerPlugin::sendCurrentFrameToPlugin(std::shared_ptr<cv::Mat> mat, ui
 			}
 		}
 		emit frameRetrieved(mat, number);
+		return true;
 	}
+	return false;
 }
 
 
@@ -506,7 +527,7 @@ void ControllerPlugin::receiveCurrentFrameNumberToPlugin(uint frameNumber)
 	Q_EMIT signalCurrentFrameNumberToPlugin(frameNumber);
 }
 
-void ControllerPlugin::receiveTrackingDone() {
-
+void ControllerPlugin::receiveTrackingDone(uint frameNumber) {
+	Q_EMIT emitTrackingDone(frameNumber);
 }
 
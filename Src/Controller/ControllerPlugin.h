@@ -55,8 +55,9 @@ public:
 
 	/**
 	 * This function hands the received cv::Mat pointer and the current frame number to the PluginLoader.
+	 * @return false if no plugin is loaded
 	 */
-	void sendCurrentFrameToPlugin(std::shared_ptr<cv::Mat> mat, uint number);
+	bool sendCurrentFrameToPlugin(std::shared_ptr<cv::Mat> mat, uint number);
 
 	void selectPlugin(QString str);
 
@@ -75,6 +76,10 @@ signals:
 	void emitUpdateView();
 	void frameRetrieved(std::shared_ptr<cv::Mat> mat, uint frameNumber);
 	void signalCurrentFrameNumberToPlugin(uint frameNumber);
+	/**
+	 * The plugin is done with frameNumber. Emitted in the order the frames were handed to the plugin.
+	 */
+	void emitTrackingDone(uint frameNumber);
 
 	// IController interface
 protected:
@@ -92,8 +97,9 @@ protected:
 	/**
 	 *
 	 * If Tracking is active and the tracking process was finished, the Plugin is able to emit a Signal that triggers this SLOT.
+	 * The result is forwarded by emitTrackingDone.
 	 */
-	void receiveTrackingDone();
+	void receiveTrackingDone(uint frameNumber);
 	/**
 	*
 	* Receive command to remove a trajectory and put it in edit queue
@@ -170,6 +176,9 @@ private:
 
 	bool m_paused = true;
 
+	// The plugin reports every frame with emitTrackingDone, the player bounds the frames in flight then
+	bool m_emitsTrackingDone = false;
+
 	uint m_currentFrameNumber = 0;
 
 
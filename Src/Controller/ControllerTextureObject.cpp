@@ -37,10 +37,10 @@ void ControllerTextureObject::connectControllerToController() {
     ctrGraphics->addTextureObject(item);
 }
 
-void ControllerTextureObject::receiveCvMat(std::shared_ptr<cv::Mat> mat, QString name) {
+void ControllerTextureObject::receiveCvMat(std::shared_ptr<cv::Mat> mat, QString name, QSize sourceSize) {
     checkIfTextureModelExists(name);
 
-    m_TextureObjects.value(name)->set(*mat);
+    m_TextureObjects.value(name)->set(*mat, sourceSize);
 
 }
 
@@ -42,8 +42,9 @@ class ControllerTextureObject : public IControllerCfg {
   public Q_SLOTS:
     /**
      * This SLOT can be triggered by any component that wants to render a cv::Mat.
+     * If mat is a downscaled preview, sourceSize is the size of the original frame. The preview is shown at that size.
      */
-    void receiveCvMat(std::shared_ptr<cv::Mat> mat, QString name);
+    void receiveCvMat(std::shared_ptr<cv::Mat> mat, QString name, QSize sourceSize = QSize());
 
   protected:
     void createModel() override;
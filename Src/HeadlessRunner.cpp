@@ -0,0 +1,251 @@
+#include "HeadlessRunner.h"
+
+#include "Controller/ControllerDataExporter.h"
+#include "Model/AreaDescriptor/AreaInfo.h"
+#include "Model/LatencyTracer.h"
+#include "Model/SyntheticScene.h"
+#include "PluginLoader.h"
+
+#include "QDebug"
+#include "QTimer"
+
+#include <algorithm>
+#include <iostream>
+
+#define RESULT_TIMEOUT_MS 60000
+
+HeadlessRunner::HeadlessRunner(QObject *parent, Config *cfg) :
+	QObject(parent),
+	_cfg(cfg),
+	m_PluginLoader(nullptr),
+	m_Plugin(nullptr),
+	m_Exporter(nullptr),
+	m_Area(nullptr),
+	m_Parameters(),
+	m_Started(false),
+	m_EndOfStream(false),
+	m_Finished(false),
+	m_InFlight(0),
+	m_PipelineFrames(1),
+	m_ResultTimer(nullptr),
+	m_Tracked(0) {
+
+	m_TrackingThread = new QThread(this);
+	m_TrackingThread->setObjectName("TrackingThread");
+	m_TrackingThread->start();
+
+	m_ResultTimer = new QTimer(this);
+	m_ResultTimer->setSingleShot(true);
+	m_ResultTimer->setInterval(RESULT_TIMEOUT_MS);
+	QObject::connect(m_ResultTimer, &QTimer::timeout, this, &HeadlessRunner::resultTimeout);
+}
+
+HeadlessRunner::~HeadlessRunner() {
+	m_TrackingThread->quit();
+	m_TrackingThread->wait();
+
+	if (m_Plugin)
+		delete m_Plugin;
+}
+
+bool HeadlessRunner::start() {
+	m_PluginLoader = new PluginLoader(this);
+	if (_cfg->UsePlugins.isEmpty() || !m_PluginLoader->loadPluginFromFilename(_cfg->UsePlugins)) {
+		std::cout << "Could not load the plugin given by --usePlugin" << std::endl;
+		return false;
+	}
+	m_Plugin = qobject_cast<IBioTrackerPlugin*>(m_PluginLoader->getPluginInstance());
+	if (!m_Plugin) {
+		std::cout << "Not a BioTracker plugin: " << _cfg->UsePlugins.toStdString() << std::endl;
+		return false;
+	}
+
+	m_Stream = openSource();
+	if (m_Stream->type() == GuiParam::MediaType::NoMedia) {
+		std::cout << "Could not open the source, use --video, --pipe, --shm, --watch or --synthetic" << std::endl;
+		return false;
+	}
+
+	// Parameters are Qt properties of the plugin object, the plugin reads them with property() (e.g. in createPlugin)
+	QObject* obj = dynamic_cast<QObject*>(m_Plugin);
+	for (const QString &parameter : _cfg->PluginParameters.split(',', QString::SkipEmptyParts)) {
+		const int separator = parameter.indexOf('=');
+		if (separator <= 0 || !obj) {
+			std::cout << "Invalid plugin parameter " << parameter.toStdString() << ", use key=value" << std::endl;
+			return false;
+		}
+		obj->setProperty(parameter.left(separator).trimmed().toUtf8().constData(), parameter.mid(separator + 1).trimmed());
+	}
+	if (!_cfg->PluginParameters.isEmpty()) {
+		std::cout << "Plugin parameters: " << _cfg->PluginParameters.toStdString() << std::endl;
+	}
+
+	m_Plugin->createPlugin();
+	m_Plugin->moveToThread(m_TrackingThread);
+
+	m_Stream->setTrackingGrayscale(_cfg->TrackingGrayscale || (obj && obj->property("grayscaleFrames").toBool()));
+
+	// The exporter works without a context, its source and file name are set here instead
+	m_Exporter = new ControllerDataExporter(this, nullptr, ENUMS::CONTROLLERTYPE::DATAEXPORT);
+	m_Exporter->setConfig(_cfg);
+	m_Exporter->setSource(m_Stream->currentFilename(), m_Stream->fps());
+	m_Exporter->setExportPath(_cfg->ExportPath);
+	m_Exporter->setDataStructure(m_Plugin->getTrackerComponentModel());
+	m_Exporter->setComponentFactory(m_Plugin->getComponentFactory());
+	if (IModelDataExporter *exporter = qobject_cast<IModelDataExporter*>(m_Exporter->getModel())) {
+		exporter->setFps(m_Stream->fps());
+		exporter->setTitle(m_Stream->getTitle());
+	}
+
+	// AreaInfo reads the config through its IControllerCfg parent
+	m_Area = new AreaInfo(m_Exporter);
+
+	QObject::connect(this, SIGNAL(updateAreaDescriptor(IModelAreaDescriptor*)), obj, SLOT(receiveAreaDescriptor(IModelAreaDescriptor*)));
+	QObject::connect(this, &HeadlessRunner::frameRetrieved, m_Plugin, &IBioTrackerPlugin::receiveCurrentFrameFromMainApp);
+	// Plugins reporting each tracked frame declare it with the "emitsTrackingDone" property. For all others a frame is
+	// done once the plugin returned from it: this connection runs on the tracking thread right after the plugin's slot.
+	if (obj && obj->property("emitsTrackingDone").toBool()) {
+		QObject::connect(obj, SIGNAL(emitTrackingDone(uint)), this, SLOT(receiveTrackingDone(uint)));
+	}
+	else {
+		QObject::connect(this, &HeadlessRunner::frameRetrieved, m_Plugin, [this](std::shared_ptr<cv::Mat>, uint frameNumber) {
+			QMetaObject::invokeMethod(this, "receiveTrackingDone", Qt::QueuedConnection, Q_ARG(uint, frameNumber));
+		});
+	}
+
+	m_Plugin->sendCorePermissions();
+
+	m_PipelineFrames = static_cast<size_t>(std::max(_cfg->TrackingPipelineFrames, 1));
+	m_Begin = std::chrono::steady_clock::now();
+	m_LastProgress = m_Begin;
+	QMetaObject::invokeMethod(this, "decode", Qt::QueuedConnection);
+	return true;
+}
+
+std::shared_ptr<BioTracker::Core::ImageStream> HeadlessRunner::openSource() {
+	if (!_cfg->LoadVideo.isEmpty())
+		return BioTracker::Core::make_ImageStream3Files(_cfg, { _cfg->LoadVideo.toStdString() });
+	if (!_cfg->LoadSharedMemory.isEmpty())
+		return BioTracker::Core::make_ImageStream3SharedMemory(_cfg, _cfg->LoadSharedMemory.toStdString());
+	if (!_cfg->LoadPipe.isEmpty())
+		return BioTracker::Core::make_ImageStream3Pipe(_cfg, _cfg->LoadPipe.toStdString());
+	if (!_cfg->WatchDirectory.isEmpty())
+		return BioTracker::Core::make_ImageStream3Directory(_cfg, _cfg->WatchDirectory.toStdString());
+	if (!_cfg->LoadSynthetic.isEmpty()) {
+		try {
+			return BioTracker::Core::make_ImageStream3Synthetic(_cfg, BioTracker::Core::SyntheticConfiguration::parse(_cfg->LoadSynthetic.toStdString()));
+		}
+		catch (const std::invalid_argument &e) {
+			qWarning() << e.what();
+		}
+	}
+	return BioTracker::Core::make_ImageStream3NoMedia();
+}
+
+bool HeadlessRunner::readFrame() {
+	// A freshly opened stream already holds its first frame
+	if (!m_Started) {
+		m_Started = true;
+		if (!m_Stream->currentFrameIsEmpty())
+			return true;
+	}
+	if (m_Stream->nextFrame())
+		return true;
+	if (m_Stream->hasNextInBatch()) {
+		m_Stream->stepToNextInBatch();
+		return m_Stream->nextFrame();
+	}
+	return false;
+}
+
+bool HeadlessRunner::isLive() const {
+	return m_Stream->type() == GuiParam::MediaType::Camera || m_Stream->numFrames() == static_cast<size_t>(-1);
+}
+
+void HeadlessRunner::decode() {
+	if (m_Finished)
+		return;
+	BioTracker::Core::LatencyTracer &tracer = BioTracker::Core::LatencyTracer::instance();
+
+	while (!m_EndOfStream && m_InFlight < m_PipelineFrames) {
+		const bool read = readFrame();
+		std::shared_ptr<cv::Mat> frame = m_Stream->currentFrame();
+		// Files end after their last frame, live sources only once they are closed (or the directory is removed)
+		if (!read && (!isLive() || m_Stream->sourceEnded())) {
+			m_EndOfStream = true;
+			break;
+		}
+		if (!frame || frame->empty()) {
+			// A frame of a file that could not be decoded is skipped
+			if (!isLive())
+				continue;
+			// A live source timed out, give the results a chance before waiting again
+			QTimer::singleShot(0, this, &HeadlessRunner::decode);
+			return;
+		}
+		const size_t frameNumber = m_Stream->currentFrameNumber();
+
+		// The area descriptor needs the frame size and is updated whenever the source file changes
+		const QString filename = QString::fromStdString(m_Stream->currentFilename());
+		if (!m_Parameters.m_CurrentFrame || m_Parameters.m_CurrentFilename != filename) {
+			m_Parameters.m_CurrentFrame = frame;
+			m_Parameters.m_CurrentFilename = filename;
+			m_Area->rcvPlayerParameters(&m_Parameters);
+			Q_EMIT updateAreaDescriptor(m_Area);
+		}
+
+		tracer.begin(m_Stream->currentDescriptor());
+		tracer.stamp(frameNumber, BioTracker::Core::FrameDescriptor::TrackerHandoff);
+		m_InFlight++;
+		if (!m_ResultTimer->isActive())
+			m_ResultTimer->start();
+		Q_EMIT frameRetrieved(m_Stream->trackingView(frame), static_cast<uint>(frameNumber));
+	}
+
+	if (m_EndOfStream && m_InFlight == 0) {
+		finish();
+	}
+}
+
+void HeadlessRunner::receiveTrackingDone(uint frameNumber) {
+	// Late results after giving up are dropped
+	if (m_Finished)
+		return;
+	if (m_InFlight)
+		m_InFlight--;
+	if (m_InFlight)
+		m_ResultTimer->start();
+	else
+		m_ResultTimer->stop();
+	m_Exporter->receiveTrackingDone(frameNumber);
+	m_Tracked++;
+
+	const auto now = std::chrono::steady_clock::now();
+	if (now - m_LastProgress > std::chrono::seconds(5)) {
+		m_LastProgress = now;
+		const double seconds = std::chrono::duration<double>(now - m_Begin).count();
+		std::cout << "Tracked " << m_Tracked << " frames (" << m_Tracked / seconds << " fps)" << std::endl;
+	}
+
+	decode();
+}
+
+void HeadlessRunner::resultTimeout() {
+	std::cout << "The plugin reported no tracked frame for " << RESULT_TIMEOUT_MS / 1000 << " s, "
+		<< m_InFlight << " frames are still in flight. Giving up." << std::endl;
+	finish(1);
+}
+
+void HeadlessRunner::finish(int exitCode) {
+	if (m_Finished)
+		return;
+	m_Finished = true;
+	m_ResultTimer->stop();
+
+	// Writes the export and reports the file written
+	m_Exporter->cleanup();
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_Begin).count();
+	std::cout << "Tracked " << m_Tracked << " frames in " << seconds << " s (" << (seconds > 0 ? m_Tracked / seconds : 0) << " fps)" << std::endl;
+	Q_EMIT finished(exitCode);
+}
@@ -0,0 +1,89 @@
+#ifndef HEADLESSRUNNER_H
+#define HEADLESSRUNNER_H
+
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <QThread>
+
+#include "Interfaces/IBioTrackerPlugin.h"
+#include "Model/ImageStream.h"
+#include "Model/MediaPlayerStateMachine/PlayerParameters.h"
+#include "util/Config.h"
+
+#include <chrono>
+#include <memory>
+
+class AreaInfo;
+class ControllerDataExporter;
+class PluginLoader;
+
+/**
+ * The HeadlessRunner tracks one source without any view. Frames go straight from the ImageStream to the plugin,
+ * results straight to the data exporter: no player thread, no texture conversion, no graphics scene and no message boxes.
+ * Frames are decoded as fast as the plugin takes them, with at most TrackingPipelineFrames frames in flight.
+ * Plugins that do not declare "emitsTrackingDone" are done with a frame once their frame slot returned.
+ * If no result comes back for RESULT_TIMEOUT_MS while frames are in flight, the runner gives up and exits with 1.
+ */
+class HeadlessRunner : public QObject {
+	Q_OBJECT
+public:
+	HeadlessRunner(QObject *parent = 0, Config *cfg = nullptr);
+	~HeadlessRunner();
+
+	/**
+	 * Loads the plugin given by UsePlugins, opens the source given on the command line and starts tracking.
+	 * @return false if the plugin or the source could not be opened
+	 */
+	bool start();
+
+Q_SIGNALS:
+	void frameRetrieved(std::shared_ptr<cv::Mat> mat, uint frameNumber);
+	void updateAreaDescriptor(IModelAreaDescriptor *area);
+	/**
+	 * The source is tracked to its end (or the plugin stopped reporting) and the export is written.
+	 */
+	void finished(int exitCode);
+
+private Q_SLOTS:
+	/**
+	 * Hands frames to the plugin until the pipeline is full or the source ends.
+	 */
+	void decode();
+	void receiveTrackingDone(uint frameNumber);
+	void resultTimeout();
+
+private:
+	std::shared_ptr<BioTracker::Core::ImageStream> openSource();
+	bool readFrame();
+	/**
+	 * True for sources without a known end (cameras, pipes, shared memory, watched directories), they wait for frames.
+	 */
+	bool isLive() const;
+	void finish(int exitCode = 0);
+
+	Config *_cfg;
+
+	PluginLoader *m_PluginLoader;
+	IBioTrackerPlugin *m_Plugin;
+	QPointer<QThread> m_TrackingThread;
+
+	ControllerDataExporter *m_Exporter;
+	AreaInfo *m_Area;
+	playerParameters m_Parameters;
+
+	std::shared_ptr<BioTracker::Core::ImageStream> m_Stream;
+	// Frames handed to the plugin and not reported done yet, at most m_PipelineFrames
+	size_t m_InFlight;
+	size_t m_PipelineFrames;
+	QTimer *m_ResultTimer;
+
+	bool m_Started;
+	bool m_EndOfStream;
+	bool m_Finished;
+	size_t m_Tracked;
+	std::chrono::steady_clock::time_point m_Begin;
+	std::chrono::steady_clock::time_point m_LastProgress;
+};
+
+#endif // HEADLESSRUNNER_H
@@ -0,0 +1,88 @@
+#include "CaptureRing.h"
+
+#include <algorithm>
+
+namespace BioTracker {
+	namespace Core {
+
+		CaptureRing::CaptureRing(GrabFunction grab, size_t capacity, bool lossless)
+			: m_grab(std::move(grab))
+			, m_lossless(lossless)
+			, m_running(true)
+			, m_sequence(0)
+			, m_frames(std::max<size_t>(capacity, 1)) {
+			m_worker = std::thread(&CaptureRing::run, this);
+		}
+
+		CaptureRing::~CaptureRing() {
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_running = false;
+			}
+			// the grab in flight finishes first, the source must be able to deliver or time out
+			if (m_worker.joinable()) {
+				m_worker.join();
+			}
+		}
+
+		bool CaptureRing::pop(Frame &frame, std::chrono::milliseconds timeout) {
+			std::unique_lock<std::mutex> lock(m_mutex);
+			if (!m_frameReady.wait_for(lock, timeout, [this] { return !m_frames.empty(); })) {
+				return false;
+			}
+
+			if (m_lossless) {
+				frame = std::move(m_frames.front());
+				m_frames.pop_front();
+			}
+			else {
+				frame = std::move(m_frames.back());
+				m_statistics.dropped += m_frames.size() - 1;
+				m_frames.clear();
+			}
+
+			const double age = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frame.captured).count();
+			m_statistics.delivered++;
+			m_statistics.ageMs = age;
+			m_statistics.maxAgeMs = std::max(m_statistics.maxAgeMs, age);
+			return true;
+		}
+
+		CaptureRing::Statistics CaptureRing::statistics() const {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_statistics;
+		}
+
+		void CaptureRing::run() {
+			for (;;) {
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					if (!m_running) {
+						return;
+					}
+				}
+
+				std::shared_ptr<cv::Mat> image = m_grab();
+				const std::chrono::steady_clock::time_point captured = std::chrono::steady_clock::now();
+				if (!image || image->empty()) {
+					// give a disconnected device a break instead of spinning
+					std::this_thread::sleep_for(std::chrono::milliseconds(10));
+					continue;
+				}
+
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (m_frames.full()) {
+					m_statistics.dropped++;
+				}
+				Frame frame;
+				frame.image = std::move(image);
+				frame.captured = captured;
+				frame.sequence = m_sequence++;
+				m_frames.push_back(std::move(frame));
+				m_statistics.captured++;
+				m_frameReady.notify_one();
+			}
+		}
+
+	}
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <boost/circular_buffer.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace BioTracker {
+namespace Core {
+
+/**
+ * The CaptureRing grabs frames from a live source on its own thread, so the driver never buffers stale frames
+ * while the player is busy. Every frame is stamped with its capture time and stored in a small ring buffer.
+ * If the ring is full, the oldest frame is overwritten. A camera cannot be paused, so that frame counts as dropped.
+ * In newest mode the consumer always gets the most recent frame and skipped frames count as dropped.
+ * In lossless mode it gets every frame in capture order, as long as it keeps up on average.
+ */
+class CaptureRing {
+public:
+	using GrabFunction = std::function<std::shared_ptr<cv::Mat>()>;
+
+	struct Frame {
+		std::shared_ptr<cv::Mat> image;
+		std::chrono::steady_clock::time_point captured;
+		size_t sequence = 0;
+	};
+
+	struct Statistics {
+		size_t captured = 0;	///< frames grabbed from the source
+		size_t delivered = 0;	///< frames handed to the consumer
+		size_t dropped = 0;		///< frames overwritten or skipped
+		double ageMs = 0;		///< age of the last delivered frame
+		double maxAgeMs = 0;	///< maximum age of a delivered frame so far
+	};
+
+	/**
+	 * @param grab function reading the next frame from the source. It is called on the capture thread only and
+	 *        may block until a frame is available. An empty (or null) frame is counted as a failed grab and skipped.
+	 * @param capacity number of frames held in the ring
+	 * @param lossless deliver every frame instead of the newest
+	 */
+	CaptureRing(GrabFunction grab, size_t capacity, bool lossless);
+	~CaptureRing();
+
+	/**
+	 * Waits at most timeout for a frame not delivered before.
+	 * @return false if no frame arrived in time
+	 */
+	bool pop(Frame &frame, std::chrono::milliseconds timeout);
+
+	Statistics statistics() const;
+
+private:
+	void run();
+
+	GrabFunction m_grab;
+	bool m_lossless;
+	bool m_running;
+	size_t m_sequence;
+	boost::circular_buffer<Frame> m_frames;
+	Statistics m_statistics;
+	mutable std::mutex m_mutex;
+	std::condition_variable m_frameReady;
+	std::thread m_worker;
+};
+
+}
+}
@@ -0,0 +1,187 @@
+#include "DirectoryFrameSource.h"
+
+#include <map>
+
+#include <boost/algorithm/string/case_conv.hpp>
+#include <QDebug>
+
+#include "util/Exceptions.h"
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace BioTracker {
+	namespace Core {
+
+		namespace {
+			const std::chrono::milliseconds WATCH_INTERVAL(100);
+		}
+
+		DirectoryFrameSource::DirectoryFrameSource(const boost::filesystem::path &directory, size_t backlog, DropPolicy policy, std::chrono::milliseconds maxLatency)
+			: m_directory(directory)
+			, m_backlog(std::max<size_t>(backlog, 1))
+			, m_policy(policy)
+			, m_maxLatency(maxLatency)
+			, m_dropped(0)
+			, m_running(true) {
+			if (!boost::filesystem::is_directory(directory)) {
+				throw directory_not_found("Could not find directory " + directory.string());
+			}
+			m_worker = std::thread(&DirectoryFrameSource::run, this);
+		}
+
+		DirectoryFrameSource::~DirectoryFrameSource() {
+			m_running = false;
+			m_spaceFree.notify_all();
+			if (m_worker.joinable()) {
+				m_worker.join();
+			}
+		}
+
+		bool DirectoryFrameSource::pop(Frame &frame, std::chrono::milliseconds timeout) {
+			std::unique_lock<std::mutex> lock(m_mutex);
+			for (;;) {
+				if (!m_frameReady.wait_for(lock, timeout, [this] { return !m_frames.empty(); })) {
+					return false;
+				}
+				frame = std::move(m_frames.front());
+				m_frames.pop_front();
+				m_spaceFree.notify_one();
+
+				const bool tooOld = m_policy != DropPolicy::Block && m_maxLatency.count() > 0
+					&& std::chrono::steady_clock::now() - frame.detected > m_maxLatency;
+				if (!tooOld) {
+					return true;
+				}
+				m_dropped++;
+			}
+		}
+
+		size_t DirectoryFrameSource::dropped() const {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_dropped;
+		}
+
+		size_t DirectoryFrameSource::backlog() const {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_frames.size();
+		}
+
+		void DirectoryFrameSource::run() {
+#if defined(__linux__)
+			watchInotify();
+#else
+			watchPolling();
+#endif
+		}
+
+#if defined(__linux__)
+		void DirectoryFrameSource::watchInotify() {
+			const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+			if (fd < 0 || inotify_add_watch(fd, m_directory.string().c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+				qWarning() << "inotify unavailable, polling" << QString::fromStdString(m_directory.string());
+				if (fd >= 0) {
+					close(fd);
+				}
+				watchPolling();
+				return;
+			}
+
+			alignas(inotify_event) char buffer[16 * 1024];
+			while (m_running) {
+				pollfd pfd{ fd, POLLIN, 0 };
+				if (poll(&pfd, 1, static_cast<int>(WATCH_INTERVAL.count())) <= 0) {
+					continue;
+				}
+				const ssize_t length = read(fd, buffer, sizeof(buffer));
+				for (ssize_t offset = 0; offset < length && m_running;) {
+					const inotify_event *event = reinterpret_cast<const inotify_event *>(buffer + offset);
+					if (event->len > 0 && !(event->mask & IN_ISDIR)) {
+						process(m_directory / event->name);
+					}
+					offset += sizeof(inotify_event) + event->len;
+				}
+			}
+			close(fd);
+		}
+#else
+		void DirectoryFrameSource::watchInotify() {
+			watchPolling();
+		}
+#endif
+
+		void DirectoryFrameSource::watchPolling() {
+			namespace fs = boost::filesystem;
+			std::set<fs::path> done;
+			std::map<fs::path, uintmax_t> pending;
+			boost::system::error_code ec;
+
+			for (fs::directory_iterator it(m_directory, ec), end; !ec && it != end; it.increment(ec)) {
+				done.insert(it->path());
+			}
+
+			while (m_running) {
+				std::this_thread::sleep_for(WATCH_INTERVAL);
+				for (fs::directory_iterator it(m_directory, ec), end; !ec && it != end && m_running; it.increment(ec)) {
+					const fs::path file = it->path();
+					if (done.count(file) || !fs::is_regular_file(file, ec)) {
+						continue;
+					}
+					// complete once the size did not change for one interval
+					const uintmax_t size = fs::file_size(file, ec);
+					auto known = pending.find(file);
+					if (known != pending.end() && known->second == size && size > 0) {
+						pending.erase(known);
+						done.insert(file);
+						process(file);
+					}
+					else {
+						pending[file] = size;
+					}
+				}
+			}
+		}
+
+		void DirectoryFrameSource::process(const boost::filesystem::path &file) {
+			if (!isImage(file)) {
+				return;
+			}
+			const auto detected = std::chrono::steady_clock::now();
+			auto image = std::make_shared<cv::Mat>(cv::imread(file.string(), cv::IMREAD_COLOR));
+			if (image->empty()) {
+				qWarning() << "Could not decode" << QString::fromStdString(file.string());
+				return;
+			}
+
+			std::unique_lock<std::mutex> lock(m_mutex);
+			if (m_frames.size() >= m_backlog) {
+				switch (m_policy) {
+				case DropPolicy::DropOldest:
+					m_frames.pop_front();
+					m_dropped++;
+					break;
+				case DropPolicy::DropNewest:
+					m_dropped++;
+					return;
+				case DropPolicy::Block:
+					m_spaceFree.wait(lock, [this] { return m_frames.size() < m_backlog || !m_running; });
+					if (!m_running) {
+						return;
+					}
+					break;
+				}
+			}
+			m_frames.push_back(Frame{ image, file.string(), detected });
+			m_frameReady.notify_one();
+		}
+
+		bool DirectoryFrameSource::isImage(const boost::filesystem::path &file) {
+			static const std::set<std::string> extensions{ ".png", ".jpg", ".jpeg", ".bmp", ".tif", ".tiff", ".pgm", ".ppm", ".pbm" };
+			return extensions.count(boost::algorithm::to_lower_copy(file.extension().string())) > 0;
+		}
+
+	}
+}
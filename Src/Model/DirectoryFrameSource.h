@@ -0,0 +1,90 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <boost/filesystem.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+namespace BioTracker {
+namespace Core {
+
+/**
+ * The DirectoryFrameSource watches a directory for images written by external capture software.
+ * A worker thread picks up every image as soon as it is completely written, decodes it and queues it.
+ * On Linux completion is signalled by inotify (the writer closed the file or moved it into the directory),
+ * elsewhere the directory is polled and a file counts as complete once its size stopped changing.
+ * Images present when watching starts are ignored.
+ */
+class DirectoryFrameSource {
+public:
+	/**
+	 * What happens to a decoded image when the backlog is full
+	 */
+	enum class DropPolicy {
+		DropOldest = 0,	///< the oldest queued image is dropped, the consumer always gets the most recent images
+		DropNewest = 1,	///< the new image is dropped
+		Block = 2		///< the worker waits until there is space (lossless, latency is unbounded)
+	};
+
+	struct Frame {
+		std::shared_ptr<cv::Mat> image;
+		std::string filename;
+		std::chrono::steady_clock::time_point detected;
+	};
+
+	/**
+	 * @param backlog maximum number of decoded images waiting for the consumer
+	 * @param maxLatency images waiting longer than this are dropped when popped (0: never, ignored for Block)
+	 * @throw directory_not_found when the directory does not exist
+	 */
+	DirectoryFrameSource(const boost::filesystem::path &directory, size_t backlog, DropPolicy policy, std::chrono::milliseconds maxLatency);
+	~DirectoryFrameSource();
+
+	/**
+	 * Waits at most timeout for the next image.
+	 * @return false if no image arrived in time
+	 */
+	bool pop(Frame &frame, std::chrono::milliseconds timeout);
+
+	/**
+	 * @return the number of images dropped by the policy or for being too old
+	 */
+	size_t dropped() const;
+
+	/**
+	 * @return the number of images currently queued
+	 */
+	size_t backlog() const;
+
+private:
+	void run();
+	void watchInotify();
+	void watchPolling();
+	void process(const boost::filesystem::path &file);
+
+	static bool isImage(const boost::filesystem::path &file);
+
+	boost::filesystem::path m_directory;
+	size_t m_backlog;
+	DropPolicy m_policy;
+	std::chrono::milliseconds m_maxLatency;
+
+	std::deque<Frame> m_frames;
+	size_t m_dropped;
+	std::atomic<bool> m_running;
+	mutable std::mutex m_mutex;
+	std::condition_variable m_frameReady;
+	std::condition_variable m_spaceFree;
+	std::thread m_worker;
+};
+
+}
+}
@@ -0,0 +1,71 @@
+#include "FrameCache.h"
+
+namespace BioTracker {
+	namespace Core {
+
+		namespace {
+			size_t frameBytes(const std::shared_ptr<cv::Mat> &frame) {
+				return frame->total() * frame->elemSize();
+			}
+
+			/**
+			* A separate header on the pixels of frame. It holds frame rather than a second reference to its data:
+			* the header is gone before frame is released, so the FramePool sees the buffer unshared and recycles it.
+			*/
+			std::shared_ptr<cv::Mat> header(const std::shared_ptr<cv::Mat> &frame) {
+				return std::shared_ptr<cv::Mat>(new cv::Mat(*frame), [frame](cv::Mat *m) { delete m; });
+			}
+		}
+
+		FrameCache::FrameCache(size_t budget)
+			: m_budget(budget)
+			, m_bytes(0)
+			, m_hits(0)
+			, m_misses(0) {
+		}
+
+		std::shared_ptr<cv::Mat> FrameCache::get(size_t frame_number) {
+			auto it = m_lookup.find(frame_number);
+			if (it == m_lookup.end()) {
+				m_misses++;
+				return nullptr;
+			}
+			m_hits++;
+			m_entries.splice(m_entries.begin(), m_entries, it->second);
+			return header(it->second->second);
+		}
+
+		void FrameCache::put(size_t frame_number, const std::shared_ptr<cv::Mat> &frame) {
+			if (!frame || frame->empty() || frameBytes(frame) > m_budget) {
+				return;
+			}
+
+			auto it = m_lookup.find(frame_number);
+			if (it != m_lookup.end()) {
+				m_bytes -= frameBytes(it->second->second);
+				m_entries.erase(it->second);
+				m_lookup.erase(it);
+			}
+
+			m_entries.emplace_front(frame_number, header(frame));
+			m_lookup[frame_number] = m_entries.begin();
+			m_bytes += frameBytes(frame);
+			evict();
+		}
+
+		void FrameCache::clear() {
+			m_entries.clear();
+			m_lookup.clear();
+			m_bytes = 0;
+		}
+
+		void FrameCache::evict() {
+			while (m_bytes > m_budget && !m_entries.empty()) {
+				m_bytes -= frameBytes(m_entries.back().second);
+				m_lookup.erase(m_entries.back().first);
+				m_entries.pop_back();
+			}
+		}
+
+	}
+}
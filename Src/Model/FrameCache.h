@@ -0,0 +1,58 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+
+namespace BioTracker {
+namespace Core {
+
+/**
+ * The FrameCache is a least-recently-used cache of decoded frames of one ImageStream, keyed by frame number.
+ * Its size is limited by a byte budget; the least recently used frames are evicted first.
+ * The cache hands out separate cv::Mat headers, so consumers reassigning their Mat do not alter cached frames.
+ * Every header keeps the frame it was made from alive instead of sharing its pixels, so a pooled buffer
+ * goes back to its FramePool once the frame is evicted and no consumer holds it anymore.
+ */
+class FrameCache {
+public:
+	explicit FrameCache(size_t budget);
+
+	/**
+	 * @return the cached frame or nullptr. Counts as hit or miss.
+	 */
+	std::shared_ptr<cv::Mat> get(size_t frame_number);
+
+	/**
+	 * Inserts (or refreshes) a frame and evicts frames until the budget is met.
+	 */
+	void put(size_t frame_number, const std::shared_ptr<cv::Mat> &frame);
+
+	/**
+	 * Drops all frames. The hit and miss counters are kept.
+	 */
+	void clear();
+
+	size_t hits() const { return m_hits; }
+	size_t misses() const { return m_misses; }
+	size_t bytes() const { return m_bytes; }
+
+private:
+	using Entry = std::pair<size_t, std::shared_ptr<cv::Mat>>;
+
+	void evict();
+
+	// most recently used first
+	std::list<Entry> m_entries;
+	std::unordered_map<size_t, std::list<Entry>::iterator> m_lookup;
+	size_t m_budget;
+	size_t m_bytes;
+	size_t m_hits;
+	size_t m_misses;
+};
+
+}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+
+namespace BioTracker {
+namespace Core {
+
+/**
+ * The FrameDescriptor travels with a frame through the pipeline and records when the frame reached each stage.
+ * Frames are identified by a sequence id (counting every frame a stream delivered) and their source frame number.
+ * A stage that has not been reached holds a default constructed time point.
+ */
+struct FrameDescriptor {
+	using Clock = std::chrono::steady_clock;
+
+	enum Stage {
+		Captured = 0,		///< the source produced the frame (camera grab, file written), the decode time for files
+		Decoded,			///< the stream delivered the frame
+		TrackerHandoff,		///< the frame was handed to the tracking plugin
+		TrackingDone,		///< the plugin reported emitTrackingDone for the frame
+		Rendered,			///< the frame was handed to the view
+		Exported,			///< the tracking result of the frame was written by the data exporter
+		StageCount
+	};
+
+	size_t sequence = 0;
+	size_t sourceFrame = 0;
+	std::array<Clock::time_point, StageCount> stamps;
+
+	bool reached(Stage stage) const {
+		return stamps[stage] != Clock::time_point();
+	}
+
+	/**
+	 * @return the time from the capture to stage in milliseconds, -1 if stage has not been reached
+	 */
+	double latencyMs(Stage stage) const {
+		if (!reached(stage) || !reached(Captured)) {
+			return -1;
+		}
+		return std::chrono::duration<double, std::milli>(stamps[stage] - stamps[Captured]).count();
+	}
+};
+
+}
+}
@@ -0,0 +1,67 @@
+#include "FramePool.h"
+
+#include <algorithm>
+
+namespace BioTracker {
+	namespace Core {
+
+		std::shared_ptr<FramePool> FramePool::create(size_t maxFree) {
+			return std::shared_ptr<FramePool>(new FramePool(maxFree));
+		}
+
+		FramePool::FramePool(size_t maxFree)
+			: m_maxFree(maxFree) {
+		}
+
+		std::shared_ptr<cv::Mat> FramePool::acquire(cv::Size size, int type) {
+			cv::Mat buffer;
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				while (!m_free.empty() && buffer.empty()) {
+					cv::Mat candidate = std::move(m_free.back());
+					m_free.pop_back();
+					if (candidate.size() == size && candidate.type() == type) {
+						buffer = std::move(candidate);
+					}
+					else {
+						// the stream's geometry changed, old buffers are of no use anymore
+						m_statistics.allocated--;
+					}
+				}
+				if (buffer.empty()) {
+					m_statistics.allocated++;
+				}
+				m_statistics.inUse++;
+				m_statistics.highWater = std::max(m_statistics.highWater, m_statistics.inUse);
+			}
+			if (buffer.empty()) {
+				buffer.create(size, type);
+			}
+
+			std::weak_ptr<FramePool> pool = shared_from_this();
+			return std::shared_ptr<cv::Mat>(new cv::Mat(buffer), [pool, buffer](cv::Mat *frame) mutable {
+				delete frame;
+				if (std::shared_ptr<FramePool> owner = pool.lock()) {
+					owner->release(std::move(buffer));
+				}
+			});
+		}
+
+		FramePool::Statistics FramePool::statistics() const {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_statistics;
+		}
+
+		void FramePool::release(cv::Mat buffer) {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_statistics.inUse--;
+			// data still shared by a copied cv::Mat header (or the pool is full): let it go
+			if ((buffer.u && buffer.u->refcount > 1) || m_free.size() >= m_maxFree) {
+				m_statistics.allocated--;
+				return;
+			}
+			m_free.push_back(std::move(buffer));
+		}
+
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace BioTracker {
+namespace Core {
+
+/**
+ * The FramePool recycles frame buffers to avoid a large allocation (and the page faults that come with it) per decoded frame.
+ * Frames handed out by acquire() return their buffer to the pool once the last std::shared_ptr to them is released,
+ * i.e. when renderer, tracker and encoder are all done with the frame.
+ * A buffer whose data is still referenced by another cv::Mat header at that time is not recycled but left to that header.
+ */
+class FramePool : public std::enable_shared_from_this<FramePool> {
+public:
+	struct Statistics {
+		size_t allocated = 0;	///< buffers owned by the pool (in use or free)
+		size_t inUse = 0;		///< buffers currently handed out
+		size_t highWater = 0;	///< maximum of inUse so far
+	};
+
+	/**
+	 * @param maxFree number of free buffers kept for reuse, additional ones are released
+	 */
+	static std::shared_ptr<FramePool> create(size_t maxFree = 16);
+
+	/**
+	 * @return a frame of the given size and type, backed by a recycled buffer if one is free
+	 */
+	std::shared_ptr<cv::Mat> acquire(cv::Size size, int type);
+
+	Statistics statistics() const;
+
+private:
+	explicit FramePool(size_t maxFree);
+
+	void release(cv::Mat buffer);
+
+	size_t m_maxFree;
+	std::vector<cv::Mat> m_free;
+	Statistics m_statistics;
+	mutable std::mutex m_mutex;
+};
+
+}
+}
@@ -0,0 +1,109 @@
+#include "FramePrefetcher.h"
+
+#include <algorithm>
+
+namespace BioTracker {
+	namespace Core {
+
+		namespace {
+			size_t frameBytes(const std::shared_ptr<cv::Mat> &frame) {
+				return frame ? frame->total() * frame->elemSize() : 0;
+			}
+		}
+
+		FramePrefetcher::FramePrefetcher(DecodeFunction decode, size_t depth, size_t memoryBudget)
+			: m_decode(std::move(decode))
+			, m_depth(std::max<size_t>(depth, 1))
+			, m_memoryBudget(memoryBudget)
+			, m_bytes(0)
+			, m_running(false)
+			, m_endOfStream(false) {
+		}
+
+		FramePrefetcher::~FramePrefetcher() {
+			flush();
+		}
+
+		void FramePrefetcher::start() {
+			if (m_worker.joinable()) {
+				return;
+			}
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_running = true;
+				m_endOfStream = false;
+			}
+			m_worker = std::thread(&FramePrefetcher::run, this);
+		}
+
+		void FramePrefetcher::flush() {
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_running = false;
+			}
+			m_spaceFree.notify_all();
+			if (m_worker.joinable()) {
+				m_worker.join();
+			}
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_frames.clear();
+			m_bytes = 0;
+			m_endOfStream = false;
+		}
+
+		std::shared_ptr<cv::Mat> FramePrefetcher::pop() {
+			start();
+
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_frameReady.wait(lock, [this] { return !m_frames.empty() || m_endOfStream; });
+			if (m_frames.empty()) {
+				return std::make_shared<cv::Mat>();
+			}
+
+			std::shared_ptr<cv::Mat> frame = m_frames.front();
+			m_frames.pop_front();
+			m_bytes -= frameBytes(frame);
+			lock.unlock();
+
+			m_spaceFree.notify_one();
+			return frame;
+		}
+
+		size_t FramePrefetcher::size() const {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_frames.size();
+		}
+
+		void FramePrefetcher::run() {
+			for (;;) {
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_spaceFree.wait(lock, [this] {
+						return !m_running || (m_frames.size() < m_depth && (m_frames.empty() || m_bytes < m_memoryBudget));
+					});
+					if (!m_running) {
+						return;
+					}
+				}
+
+				std::shared_ptr<cv::Mat> frame = m_decode();
+
+				std::lock_guard<std::mutex> lock(m_mutex);
+				// flushed while decoding: the frame belongs to the old position
+				if (!m_running) {
+					return;
+				}
+				if (!frame || frame->empty()) {
+					m_endOfStream = true;
+					m_frameReady.notify_all();
+					return;
+				}
+				m_bytes += frameBytes(frame);
+				m_frames.push_back(std::move(frame));
+				m_frameReady.notify_one();
+			}
+		}
+
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace BioTracker {
+namespace Core {
+
+/**
+ * The FramePrefetcher decodes frames ahead of the play head on a background thread.
+ * Decoded frames are kept in a bounded queue which is limited by a number of frames and a memory budget.
+ * The decode function is called on the worker thread only. It has to return an empty (or null) frame once the source is exhausted.
+ */
+class FramePrefetcher {
+public:
+	using DecodeFunction = std::function<std::shared_ptr<cv::Mat>()>;
+
+	/**
+	 * @param decode function producing the next frame of the source
+	 * @param depth maximum number of decoded frames held ahead of the consumer
+	 * @param memoryBudget maximum number of bytes held ahead of the consumer. At least one frame is always buffered.
+	 */
+	FramePrefetcher(DecodeFunction decode, size_t depth, size_t memoryBudget);
+	~FramePrefetcher();
+
+	/**
+	 * Starts the worker thread. Does nothing if the worker is already running or has reached the end of the source.
+	 */
+	void start();
+
+	/**
+	 * Stops the worker thread and drops all buffered frames.
+	 * Must be called before the source is repositioned or reopened, as the worker is the only one accessing it while running.
+	 */
+	void flush();
+
+	/**
+	 * Returns the next decoded frame, blocking until it is available. Starts the worker if needed.
+	 * Returns an empty frame once the end of the source is reached.
+	 */
+	std::shared_ptr<cv::Mat> pop();
+
+	/**
+	 * @return the number of frames currently buffered
+	 */
+	size_t size() const;
+
+private:
+	void run();
+
+	DecodeFunction m_decode;
+	size_t m_depth;
+	size_t m_memoryBudget;
+	size_t m_bytes;
+	bool m_running;
+	bool m_endOfStream;
+	std::deque<std::shared_ptr<cv::Mat>> m_frames;
+	mutable std::mutex m_mutex;
+	std::condition_variable m_frameReady;
+	std::condition_variable m_spaceFree;
+	std::thread m_worker;
+};
+
+}
+}
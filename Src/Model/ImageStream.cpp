@@ -1,20 +1,41 @@
 #include "ImageStream.h"
 
 #include "util/stdext.h"
+#include <algorithm>  // std::max
 #include <cassert>    // assert
+#include <cstdio>     // std::fread
+#include <cstring>    // std::memcpy
 #include <stdexcept>  // std::invalid_argument
+#include <atomic>
 #include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <future>
 #include <mutex>
 #include <thread>
+#include <deque>
 #include <limits>
+#include <map>
 
 #include <boost/circular_buffer.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <QImageReader>
 
 #include "util/Exceptions.h"
 #include "QSharedPointer"
 #include "Utility/misc.h"
 #include "View/CameraDevice.h"
 #include "util/VideoCoder.h"
+#include "Model/FrameCache.h"
+#include "Model/DirectoryFrameSource.h"
+#include "Model/FramePrefetcher.h"
+#include "Model/PicturePrefetcher.h"
+#include "Model/LibavDecoder.h"
+#include "Model/RawFrameFile.h"
+#include "Model/SharedFrameRing.h"
+#include "Model/VideoIndex.h"
 
 #include "Controller/IControllerCfg.h"
 
@@ -22,6 +43,10 @@
 #include "util/camera/pylon.h"
 #include <opencv2/opencv.hpp>
 #endif
+#ifdef _WIN32
+#include <fcntl.h>  // _O_BINARY
+#include <io.h>     // _setmode
+#endif
 #include <iostream>
 
 namespace BioTracker {
@@ -29,7 +54,8 @@ namespace BioTracker {
 
 		ImageStream::ImageStream(QObject *parent, Config *cfg) : QObject(parent),
 			m_current_frame(new cv::Mat(cv::Size(0, 0), CV_8UC3)),
-			m_current_frame_number(0) {
+			m_current_frame_number(0),
+			m_frame_pool(FramePool::create()) {
 			_cfg = cfg;
 			if (cfg)
 				m_frame_stride = cfg->FrameStride;
@@ -50,9 +76,15 @@ namespace BioTracker {
 				if (frame_number == this->currentFrameNumber()) {
 					return true;
 				}
+				else if (this->serveFromCache(frame_number)) {
+					return true;
+				}
 				else {
 					const bool success = this->setFrameNumber_impl(frame_number);
 					m_current_frame_number = frame_number;
+					if (success) {
+						this->cacheCurrentFrame();
+					}
 					return success;
 				}
 			}
@@ -80,6 +112,9 @@ namespace BioTracker {
 			if (new_frame_number < this->numFrames()) {
 				const bool success = this->nextFrame_impl();
 				m_current_frame_number = new_frame_number;
+				if (success) {
+					this->cacheCurrentFrame();
+				}
 				return success;
 			}
 			else {
@@ -91,8 +126,14 @@ namespace BioTracker {
 		bool ImageStream::previousFrame() {
 			if (this->currentFrameNumber() > 0) {
 				const size_t new_frame_numer = this->currentFrameNumber() - 1;
+				if (this->serveFromCache(new_frame_numer)) {
+					return true;
+				}
 				const bool success = this->previousFrame_impl();
 				m_current_frame_number = new_frame_numer;
+				if (success) {
+					this->cacheCurrentFrame();
+				}
 				return success;
 			}
 			else {
@@ -103,6 +144,23 @@ namespace BioTracker {
 
 		void ImageStream::set_current_frame(std::shared_ptr<cv::Mat> img) {
 			m_current_frame.swap(img);
+
+			// streams knowing the capture time overwrite it with setCaptureTime afterwards
+			const FrameDescriptor::Clock::time_point now = FrameDescriptor::Clock::now();
+			m_current_descriptor = FrameDescriptor();
+			m_current_descriptor.sequence = m_sequence++;
+			m_current_descriptor.stamps[FrameDescriptor::Captured] = now;
+			m_current_descriptor.stamps[FrameDescriptor::Decoded] = now;
+		}
+
+		void ImageStream::setCaptureTime(FrameDescriptor::Clock::time_point captured) {
+			m_current_descriptor.stamps[FrameDescriptor::Captured] = captured;
+		}
+
+		FrameDescriptor ImageStream::currentDescriptor() const {
+			FrameDescriptor descriptor = m_current_descriptor;
+			descriptor.sourceFrame = m_current_frame_number;
+			return descriptor;
 		}
 
 		void ImageStream::clearImage() {
@@ -133,6 +191,116 @@ namespace BioTracker {
 			return {};
 		}
 
+		size_t ImageStream::frameCacheHits() const {
+			return m_frame_cache ? m_frame_cache->hits() : 0;
+		}
+
+		size_t ImageStream::frameCacheMisses() const {
+			return m_frame_cache ? m_frame_cache->misses() : 0;
+		}
+
+		void ImageStream::enableFrameCache() {
+			if (_cfg && _cfg->FrameCacheMB > 0) {
+				m_frame_cache = std::make_unique<FrameCache>(static_cast<size_t>(_cfg->FrameCacheMB) * 1024 * 1024);
+			}
+		}
+
+		void ImageStream::invalidateFrameCache() {
+			if (m_frame_cache) {
+				qDebug() << "Frame cache hits/misses:" << m_frame_cache->hits() << "/" << m_frame_cache->misses();
+				m_frame_cache->clear();
+			}
+		}
+
+		void ImageStream::frameServedFromCache(size_t) {
+		}
+
+		FramePool::Statistics ImageStream::framePoolStatistics() const {
+			return m_frame_pool->statistics();
+		}
+
+		CaptureRing::Statistics ImageStream::captureStatistics() const {
+			return CaptureRing::Statistics();
+		}
+
+		bool ImageStream::sourceEnded() const {
+			return false;
+		}
+
+		void ImageStream::setCropRegion(const cv::Rect &region) {
+			m_crop_region = region;
+		}
+
+		cv::Rect ImageStream::cropRegion() const {
+			return m_crop_region;
+		}
+
+		void ImageStream::setTrackingGrayscale(bool grayscale) {
+			m_tracking_grayscale = grayscale;
+		}
+
+		bool ImageStream::trackingGrayscale() const {
+			return m_tracking_grayscale;
+		}
+
+		std::shared_ptr<cv::Mat> ImageStream::trackingView(const std::shared_ptr<cv::Mat> &frame) {
+			if (!frame || frame->empty()) {
+				return frame;
+			}
+			std::shared_ptr<cv::Mat> full = m_tracking_grayscale ? grayFrame(frame) : frame;
+			if (m_crop_region.area() <= 0) {
+				return full;
+			}
+			const cv::Rect region = m_crop_region & cv::Rect(0, 0, full->cols, full->rows);
+			if (region.area() <= 0 || region.size() == full->size()) {
+				return full;
+			}
+			// the deleter holds the full frame, so views of non owned data (e.g. mapped files) stay valid
+			return std::shared_ptr<cv::Mat>(new cv::Mat(*full, region), [full](cv::Mat *m) { delete m; });
+		}
+
+		std::shared_ptr<cv::Mat> ImageStream::grayFrame(const std::shared_ptr<cv::Mat> &frame) {
+			if (frame->channels() == 1) {
+				return frame;
+			}
+			// converted once per frame, no matter how often it is asked for
+			if (!m_gray_frame || m_gray_source.lock() != frame) {
+				m_gray_frame = acquireFrame(frame->size(), CV_MAKETYPE(frame->depth(), 1));
+				cv::cvtColor(*frame, *m_gray_frame, frame->channels() == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+				m_gray_source = frame;
+			}
+			return m_gray_frame;
+		}
+
+		void ImageStream::setCurrentGrayFrame(std::shared_ptr<cv::Mat> gray) {
+			m_gray_source = m_current_frame;
+			m_gray_frame = std::move(gray);
+		}
+
+		std::shared_ptr<cv::Mat> ImageStream::acquireFrame(cv::Size size, int type) {
+			return m_frame_pool->acquire(size, type);
+		}
+
+		bool ImageStream::serveFromCache(size_t frame_number) {
+			if (!m_frame_cache) {
+				return false;
+			}
+			std::shared_ptr<cv::Mat> cached = m_frame_cache->get(frame_number);
+			if (!cached) {
+				return false;
+			}
+			this->set_current_frame(cached);
+			m_current_frame_number = frame_number;
+			this->frameServedFromCache(frame_number);
+			return true;
+		}
+
+		void ImageStream::cacheCurrentFrame() {
+			if (m_frame_cache) {
+				m_frame_cache->put(m_current_frame_number, m_current_frame);
+			}
+		}
+
 		ImageStream::~ImageStream() = default;
 
 
@@ -174,6 +342,8 @@ namespace BioTracker {
 				:  ImageStream(0, cfg)
 				,m_picture_files(std::move(picture_files)), m_currentFrame(0) {
 
+				enableFrameCache();
+
 				//Grab the codec from config file
                 double fps = _cfg->RecordFPS;
                 if (fps > 0) {
@@ -186,13 +356,20 @@ namespace BioTracker {
 
 				// load first image
 				if (this->numFrames() > 0) {
-					this->setFrameNumber_impl(0);
-					std::string filename = m_picture_files[0].string();
-					std::shared_ptr<cv::Mat> new_frame = std::make_shared<cv::Mat>(cv::imread(filename));
-					m_w = new_frame->size().width;
-					m_h = new_frame->size().height;
 					m_recording = false;
 					vCoder = std::make_shared<VideoCoder>(m_fps, _cfg);
+
+					// the dimensions are read from the file header, no need to decode the image for it
+					const QSize size = QImageReader(QString::fromStdString(m_picture_files[0].string())).size();
+					this->setFrameNumber_impl(0);
+					if (size.isValid()) {
+						m_w = size.width();
+						m_h = size.height();
+					}
+					else {
+						m_w = currentFrame()->size().width;
+						m_h = currentFrame()->size().height;
+					}
 				}
 
 			}
@@ -206,69 +383,1595 @@ namespace BioTracker {
 				if (this->numFrames() <= 0) {
 					return false;
 				}
-				m_recording = vCoder->toggle(m_w, m_h, m_fps);
-
+				m_recording = vCoder->toggle(m_w, m_h, m_fps);
+
+				return m_recording;
+			}
+			virtual double fps() const override {
+				return m_fps;
+			}
+			virtual std::string currentFilename() const override {
+				assert(currentFrameNumber() < m_picture_files.size());
+				return m_picture_files[currentFrameNumber()].string();
+			}
+
+		private:
+			virtual void frameServedFromCache(size_t frame_number) override {
+				m_currentFrame = static_cast<int>(frame_number);
+			}
+
+			virtual bool nextFrame_impl() override {
+				m_currentFrame += static_cast<int>(m_frame_stride);
+				if (this->numFrames() > m_currentFrame) {
+
+					std::shared_ptr<cv::Mat> new_frame = loadPicture(m_currentFrame);
+					this->set_current_frame(new_frame);
+					if (m_recording) {
+						if (vCoder) vCoder->add(new_frame);
+					}
+					return true;
+				}
+				return false;
+			}
+
+			virtual bool setFrameNumber_impl(size_t frame_number) override {
+				std::shared_ptr<cv::Mat> new_frame = loadPicture(frame_number);
+				this->set_current_frame(new_frame);
+				m_currentFrame = static_cast<int>(frame_number);
+				if (m_recording) {
+					if (vCoder) vCoder->add(new_frame);
+				}
+				return !new_frame->empty();
+			}
+
+			static std::shared_ptr<cv::Mat> readPicture(const boost::filesystem::path &file) {
+				return std::make_shared<cv::Mat>(cv::imread(file.string()));
+			}
+
+			/**
+			* Returns the decoded picture with the given index.
+			* If PicturePrefetchDepth is set, the following pictures (every m_frame_stride'th, skipped ones are never read)
+			* are decoded in parallel by a pool of PicturePrefetchDepth workers (at most one per core).
+			*/
+			std::shared_ptr<cv::Mat> loadPicture(size_t index) {
+				const size_t depth = static_cast<size_t>(std::max(_cfg->PicturePrefetchDepth, 0));
+				if (depth == 0) {
+					return readPicture(m_picture_files[index]);
+				}
+				if (!m_prefetcher) {
+					const size_t workers = std::min<size_t>(depth, std::max(std::thread::hardware_concurrency(), 1u));
+					m_prefetcher = std::make_unique<PicturePrefetcher>([this](size_t i) { return readPicture(m_picture_files[i]); }, workers);
+				}
+
+				std::shared_ptr<cv::Mat> picture = m_prefetcher->take(index);
+				if (!picture) {
+					// not read ahead (seek): the pictures read ahead are obsolete, reads in progress are not waited for
+					m_prefetcher->cancel();
+					picture = readPicture(m_picture_files[index]);
+				}
+
+				for (size_t i = 1; i <= depth && index + i * m_frame_stride < this->numFrames(); i++) {
+					m_prefetcher->request(index + i * m_frame_stride);
+				}
+				return picture;
+			}
+
+			std::vector<boost::filesystem::path> m_picture_files;
+			std::unique_ptr<PicturePrefetcher> m_prefetcher;
+			std::shared_ptr<VideoCoder> vCoder;
+			double m_w;
+			double m_h;
+			bool m_recording;
+			int m_currentFrame;
+			double m_fps;
+		};
+
+
+		/*********************************************************/
+
+
+		class ImageStream3Video : public ImageStream {
+		public:
+			/**
+			* @throw file_not_found when the file does not exists
+			* @throw video_open_error when there is an error with the video
+			* @brief ImageStreamVideo
+			* @param filename path to the file
+			* @param index keyframe index of the first file built by the owner (e.g. a timeline indexing all its files),
+			*        the stream then does not build its own
+			*/
+			explicit ImageStream3Video(Config *cfg, const std::vector<boost::filesystem::path> &files,
+				std::shared_future<std::shared_ptr<VideoIndex>> index = {})
+				: ImageStream(0, cfg)
+				, m_ownerIndex(std::move(index))
+			{
+				enableFrameCache();
+
+				// decode ahead of the play head on a background thread, if enabled
+				if (_cfg->VideoPrefetchDepth > 0) {
+					const size_t budget = static_cast<size_t>(std::max(_cfg->VideoPrefetchMemoryMB, 0)) * 1024 * 1024;
+					m_prefetcher = std::make_unique<FramePrefetcher>([this]() { return decodeFrame(); },
+						static_cast<size_t>(_cfg->VideoPrefetchDepth), budget);
+				}
+				openMedia(files);
+			}
+			~ImageStream3Video() {
+				m_cancelIndex = true;
+			}
+			virtual GuiParam::MediaType type() const override {
+				return GuiParam::MediaType::Video;
+			}
+			virtual size_t numFrames() const override {
+				// CAP_PROP_FRAME_COUNT is only an estimate for many containers
+				if (const VideoIndex *index = seekIndex()) {
+					return index->numFrames();
+				}
+				return m_num_frames;
+			}
+			virtual bool toggleRecord() override {
+				if (!m_capture->isOpened()) {
+					return false;
+				}
+				m_recording = vCoder->toggle(m_w, m_h, m_fps);
+
+				return m_recording;
+			}
+			virtual double fps() const override {
+				return m_fps;
+			}
+			virtual std::string currentFilename() const override {
+				return m_fileName;
+			}
+			
+			virtual bool hasNextInBatch() override{
+				return !(m_batch.empty());
+			}
+
+			virtual void stepToNextInBatch() override{
+				if (m_batch.empty()) {
+					throw video_open_error("batch is empty");
+				}
+				openMedia(m_batch);
+			} 
+
+			virtual std::vector<std::string> getBatchItems() override{
+				std::vector<std::string> batchItems;
+				for (auto x: m_batch){
+					batchItems.push_back(x.string());
+				}
+				return batchItems;
+			}
+
+			/**
+			* @return the keyframe index of the current file as it is loaded or built, invalid without VideoSeekIndex
+			*/
+			std::shared_future<std::shared_ptr<VideoIndex>> index() const {
+				return m_indexBuild;
+			}
+
+		private:
+
+			/**
+			* A video opened (and its first frames decoded) off the player thread, ready to be swapped in.
+			*/
+			struct PreparedVideo {
+				boost::filesystem::path file;
+				std::unique_ptr<cv::VideoCapture> capture;
+				size_t numFrames;
+				double fps;
+				double w;
+				double h;
+				std::deque<std::shared_ptr<cv::Mat>> frames;
+			};
+
+			/**
+			* Opens file and decodes its first predecode frames (honouring the frame stride).
+			* @throw file_not_found when the file does not exists
+			* @throw video_open_error when there is an error with the video
+			*/
+			std::unique_ptr<PreparedVideo> prepareVideo(const boost::filesystem::path &file, size_t predecode) {
+				auto video = std::make_unique<PreparedVideo>();
+				video->file = file;
+				video->capture = std::make_unique<cv::VideoCapture>(file.string());
+				video->numFrames = static_cast<size_t>(video->capture->get(cv::CAP_PROP_FRAME_COUNT));
+				video->fps = video->capture->get(cv::CAP_PROP_FPS);
+
+				if (!boost::filesystem::exists(file)) {
+					throw file_not_found("Could not find file " + file.string());
+				}
+				if (!video->capture->isOpened()) {
+					throw video_open_error(":(");
+				}
+
+				video->w = video->capture->get(cv::CAP_PROP_FRAME_WIDTH);
+				video->h = video->capture->get(cv::CAP_PROP_FRAME_HEIGHT);
+				for (size_t i = 0; i < predecode; i++) {
+					std::shared_ptr<cv::Mat> frame = acquireFrame(cv::Size(static_cast<int>(video->w), static_cast<int>(video->h)), CV_8UC3);
+					for (int j = 0; j < m_frame_stride; j++)
+						*video->capture >> *frame;
+					if (frame->empty()) {
+						break;
+					}
+					video->frames.push_back(frame);
+				}
+				return video;
+			}
+
+			void openMedia(std::vector<boost::filesystem::path> files){
+
+				// the prefetch worker must not touch the capture while it is reopened
+				if (m_prefetcher) {
+					m_prefetcher->flush();
+				}
+
+				// an index still being built belongs to the previous file (one built by the owner is cancelled by the owner)
+				m_cancelIndex = true;
+				if (m_indexBuild.valid() && m_buildsIndex) {
+					m_indexBuild.wait();
+				}
+				m_cancelIndex = false;
+				m_indexBuild = {};
+				m_buildsIndex = false;
+				m_index.reset();
+				m_reverseChunk.clear();
+				m_captureMoved = false;
+				invalidateFrameCache();
+
+				// use the pre-opened video if it is the requested one, opening errors are rethrown here
+				std::unique_ptr<PreparedVideo> video;
+				if (m_nextVideo.valid()) {
+					std::unique_ptr<PreparedVideo> next = m_nextVideo.get();
+					if (next && next->file == files.front()) {
+						video = std::move(next);
+					}
+				}
+				if (!video) {
+					video = prepareVideo(files.front(), 0);
+				}
+
+				m_capture = std::move(video->capture);
+				m_predecoded = std::move(video->frames);
+				m_num_frames = video->numFrames;
+				m_fps = video->fps;
+				m_fileName = files.front().string();
+
+                m_batch = files;
+                m_batch.erase(m_batch.begin(), m_batch.begin()+1);
+
+                //Grab the fps from config file
+                double fps = _cfg->RecordFPS;
+                if (fps != -1) {
+                    m_fps = fps;
+                }
+
+				m_w = video->w;
+				m_h = video->h;
+				m_recording = false;
+				vCoder = std::make_shared<VideoCoder>(m_fps, _cfg);
+
+				// load the keyframe index from its sidecar or build it in the background
+				if (m_ownerIndex.valid()) {
+					m_indexBuild = std::move(m_ownerIndex);
+					m_ownerIndex = {};
+				}
+				else if (_cfg->VideoSeekIndex) {
+					m_indexBuild = std::async(std::launch::async, &VideoIndex::open, files.front(), &m_cancelIndex).share();
+					m_buildsIndex = true;
+				}
+
+				// load first image
+				if (this->numFrames() > 0) {
+					this->nextFrame_impl();
+				}
+
+				m_current_frame_number = 0;
+
+				// open the next batch item while this one is played
+				if (!m_batch.empty() && _cfg->BatchPreopenFrames > 0) {
+					m_nextVideo = std::async(std::launch::async, [this](boost::filesystem::path file, size_t predecode) {
+						try {
+							return prepareVideo(file, predecode);
+						}
+						catch (const std::exception &) {
+							// reported when the item is actually opened
+							return std::unique_ptr<PreparedVideo>();
+						}
+					}, m_batch.front(), static_cast<size_t>(_cfg->BatchPreopenFrames));
+				}
+			}
+
+			/**
+			* Decodes the next frame (honouring the frame stride) from the capture.
+			* Runs on the prefetch worker if prefetching is enabled.
+			*/
+			std::shared_ptr<cv::Mat> decodeFrame() {
+				// frames decoded while the video was pre-opened come first
+				if (!m_predecoded.empty()) {
+					std::shared_ptr<cv::Mat> frame = m_predecoded.front();
+					m_predecoded.pop_front();
+					return frame;
+				}
+				std::shared_ptr<cv::Mat> new_frame = acquireFrame(cv::Size(static_cast<int>(m_w), static_cast<int>(m_h)), CV_8UC3);
+				for (int i = 0; i<m_frame_stride; i++)
+					*m_capture >> *new_frame;
+				return new_frame;
+			}
+
+			virtual bool nextFrame_impl() override {
+				releaseReverseChunk(this->currentFrameNumber() + m_frame_stride);
+
+				// frames were served from the reverse chunk, the capture is not behind the current frame
+				if (m_captureMoved) {
+					if (m_prefetcher) {
+						m_prefetcher->flush();
+					}
+					seekTo(this->currentFrameNumber() + 1);
+					m_captureMoved = false;
+				}
+
+				std::shared_ptr<cv::Mat> mat = m_prefetcher ? m_prefetcher->pop() : decodeFrame();
+				this->set_current_frame(mat);
+				if (m_recording) {
+					if (vCoder) vCoder->add(mat);
+				}
+				return !mat->empty();
+			}
+
+			virtual bool setFrameNumber_impl(size_t frame_number) override {
+				// new frame is next frame --> use next frame function
+				if (this->currentFrameNumber() + 1 == frame_number) {
+					return this->nextFrame_impl();
+				}
+				else {
+					// frames decoded ahead belong to the old position
+					if (m_prefetcher) {
+						m_prefetcher->flush();
+					}
+					releaseReverseChunk(frame_number);
+					seekTo(frame_number);
+					m_captureMoved = false;
+					return this->nextFrame_impl();
+				}
+			}
+
+			virtual void frameServedFromCache(size_t) override {
+				m_captureMoved = true;
+			}
+
+			/**
+			* Stepping back is served from a chunk of decoded frames ending at the requested frame.
+			* If the frame is not in the chunk, the chunk is refilled by decoding forward from the preceding keyframe,
+			* so one seek is paid per GOP instead of per frame.
+			*/
+			virtual bool previousFrame_impl() override {
+				const size_t target = this->currentFrameNumber() - 1;
+				auto it = m_reverseChunk.find(target);
+				bool refilled = false;
+				if (it == m_reverseChunk.end()) {
+					decodeReverseChunk(target);
+					it = m_reverseChunk.find(target);
+					refilled = true;
+				}
+
+				std::shared_ptr<cv::Mat> mat = it != m_reverseChunk.end() ? it->second : std::make_shared<cv::Mat>();
+				// only right after a successful refill the capture is positioned behind the target
+				m_captureMoved = !refilled || it == m_reverseChunk.end();
+
+				this->set_current_frame(mat);
+				if (m_recording) {
+					if (vCoder) vCoder->add(mat);
+				}
+				return !mat->empty();
+			}
+
+			/**
+			* Decodes the frames from the keyframe preceding target up to target, at most ReverseChunkFrames frames
+			* and ReverseChunkMB (or FrameCacheMB, if smaller) of decoded frames.
+			*/
+			void decodeReverseChunk(size_t target) {
+				size_t budgetMB = static_cast<size_t>(std::max(_cfg->ReverseChunkMB, 1));
+				if (_cfg->FrameCacheMB > 0) {
+					budgetMB = std::min(budgetMB, static_cast<size_t>(_cfg->FrameCacheMB));
+				}
+				const size_t frameBytes = std::max<size_t>(static_cast<size_t>(m_w * m_h) * 3, 1);
+				const size_t maxFrames = std::max<size_t>(std::min(static_cast<size_t>(std::max(_cfg->ReverseChunkFrames, 1)),
+					budgetMB * 1024 * 1024 / frameBytes), 1);
+				size_t first = target + 1 > maxFrames ? target + 1 - maxFrames : 0;
+				const VideoIndex *index = seekIndex();
+				if (index && index->hasKeyframes()) {
+					first = std::max(first, index->keyframeBefore(target));
+				}
+
+				m_reverseChunk.clear();
+				if (m_prefetcher) {
+					m_prefetcher->flush();
+				}
+				seekTo(first);
+				for (size_t frame_number = first; frame_number <= target; frame_number++) {
+					std::shared_ptr<cv::Mat> frame = acquireFrame(cv::Size(static_cast<int>(m_w), static_cast<int>(m_h)), CV_8UC3);
+					*m_capture >> *frame;
+					if (frame->empty()) {
+						break;
+					}
+					m_reverseChunk.emplace(frame_number, frame);
+				}
+			}
+
+			/**
+			* Drops the reverse chunk once playback leaves it for frame_number, it may hold up to ReverseChunkMB.
+			*/
+			void releaseReverseChunk(size_t frame_number) {
+				if (!m_reverseChunk.empty()
+					&& (frame_number < m_reverseChunk.begin()->first || frame_number > m_reverseChunk.rbegin()->first)) {
+					m_reverseChunk.clear();
+				}
+			}
+
+			/**
+			* Positions the capture so that frame_number is the frame to be decoded next.
+			* With a keyframe index the capture jumps to the preceding keyframe (unless it already is between keyframe and target)
+			* and decodes forward from there, which is fast and frame-accurate.
+			*/
+			void seekTo(size_t frame_number) {
+				// the capture is behind the pre-decoded frames
+				m_predecoded.clear();
+				const VideoIndex *index = seekIndex();
+				if (!index || !index->hasKeyframes()) {
+					// adjust frame position ("0-based index of the frame to be decoded/captured next.")
+					m_capture->set(cv::CAP_PROP_POS_FRAMES, static_cast<double>(frame_number));
+					return;
+				}
+
+				const size_t keyframe = index->keyframeBefore(frame_number);
+				size_t position = static_cast<size_t>(m_capture->get(cv::CAP_PROP_POS_FRAMES));
+				if (position < keyframe || position > frame_number) {
+					m_capture->set(cv::CAP_PROP_POS_FRAMES, static_cast<double>(keyframe));
+					position = keyframe;
+				}
+				for (; position < frame_number; position++) {
+					m_capture->grab();
+				}
+			}
+
+			/**
+			* @return the keyframe index, nullptr if it is disabled or not built yet
+			*/
+			const VideoIndex *seekIndex() const {
+				if (!m_index && m_indexBuild.valid()
+					&& m_indexBuild.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+					m_index = m_indexBuild.get();
+				}
+				return m_index.get();
+			}
+
+			std::unique_ptr<cv::VideoCapture> m_capture;
+			size_t     m_num_frames;
+			std::string m_fileName;
+			std::shared_ptr<VideoCoder> vCoder;
+            std::vector<boost::filesystem::path> m_batch;
+			double m_fps;
+			double m_w;
+			double m_h;
+			bool m_recording;
+			mutable std::shared_ptr<VideoIndex> m_index;
+			std::atomic<bool> m_cancelIndex{ false };
+			mutable std::shared_future<std::shared_ptr<VideoIndex>> m_indexBuild;
+			std::shared_future<std::shared_ptr<VideoIndex>> m_ownerIndex;
+			bool m_buildsIndex = false;
+			std::map<size_t, std::shared_ptr<cv::Mat>> m_reverseChunk;
+			bool m_captureMoved = false;
+			std::deque<std::shared_ptr<cv::Mat>> m_predecoded;
+			// waited for on destruction, before the members used by prepareVideo are gone
+			std::future<std::unique_ptr<PreparedVideo>> m_nextVideo;
+			// declared last so the worker is stopped before the capture is destroyed
+			std::unique_ptr<FramePrefetcher> m_prefetcher;
+		};
+
+#if HAS_LIBAV
+		/*********************************************************/
+
+
+		/**
+		* Video backend decoding with libavcodec directly (Config::VideoBackend), see LibavDecoder.
+		* Frames are converted into pooled BGR buffers, or gray ones if Config::LibavGray is set.
+		*/
+		class ImageStream3LibavVideo : public ImageStream {
+		public:
+			/**
+			* @throw file_not_found when the file does not exists
+			* @throw video_open_error when there is an error with the video
+			*/
+			explicit ImageStream3LibavVideo(Config *cfg, const std::vector<boost::filesystem::path> &files)
+				: ImageStream(0, cfg)
+			{
+				enableFrameCache();
+				openMedia(files);
+			}
+			~ImageStream3LibavVideo() {
+				m_cancelIndex = true;
+			}
+			virtual GuiParam::MediaType type() const override {
+				return GuiParam::MediaType::Video;
+			}
+			virtual size_t numFrames() const override {
+				// the container's estimate until the index is built
+				if (const VideoIndex *index = seekIndex()) {
+					return index->numFrames();
+				}
+				return m_num_frames;
+			}
+			virtual bool toggleRecord() override {
+				m_recording = vCoder->toggle(m_size.width, m_size.height, m_fps);
+				return m_recording;
+			}
+			virtual double fps() const override {
+				return m_fps;
+			}
+			virtual std::string currentFilename() const override {
+				return m_fileName;
+			}
+			virtual bool hasNextInBatch() override {
+				return !m_batch.empty();
+			}
+			virtual void stepToNextInBatch() override {
+				if (m_batch.empty()) {
+					throw video_open_error("batch is empty");
+				}
+				openMedia(m_batch);
+			}
+			virtual std::vector<std::string> getBatchItems() override {
+				std::vector<std::string> batchItems;
+				for (auto x : m_batch) {
+					batchItems.push_back(x.string());
+				}
+				return batchItems;
+			}
+
+			/**
+			* @return the presentation timestamp of the current frame in microseconds
+			*/
+			int64_t frameTimestamp() const {
+				return m_decoder->timestamp();
+			}
+
+		private:
+			void openMedia(const std::vector<boost::filesystem::path> &files) {
+				const boost::filesystem::path &file = files.front();
+				if (!boost::filesystem::exists(file)) {
+					throw file_not_found("Could not find file " + file.string());
+				}
+				invalidateFrameCache();
+
+				// an index still being built belongs to the previous file
+				m_cancelIndex = true;
+				if (m_indexBuild.valid()) {
+					m_indexBuild.wait();
+				}
+				m_cancelIndex = false;
+				m_indexBuild = {};
+				m_index.reset();
+
+				m_decoder.reset(new LibavDecoder(file, _cfg->LibavThreads,
+					static_cast<LibavDecoder::Threading>(std::min(std::max(_cfg->LibavThreadType, 0), 2))));
+				m_decoderMoved = false;
+
+				m_num_frames = m_decoder->numFrames();
+				// counted in the background like the OpenCV backend does, a fresh video is not scanned before its first frame
+				if (_cfg->VideoSeekIndex) {
+					m_indexBuild = std::async(std::launch::async, &VideoIndex::open, file, &m_cancelIndex);
+				}
+				m_size = m_decoder->size();
+				m_fps = _cfg->RecordFPS != -1 ? _cfg->RecordFPS : m_decoder->fps();
+				m_fileName = file.string();
+				m_batch.assign(files.begin() + 1, files.end());
+				m_recording = false;
+				vCoder = std::make_shared<VideoCoder>(m_fps, _cfg);
+
+				// load first image
+				if (m_num_frames > 0) {
+					this->nextFrame_impl();
+				}
+				m_current_frame_number = 0;
+			}
+
+			std::shared_ptr<cv::Mat> decodeFrame() {
+				std::shared_ptr<cv::Mat> frame = acquireFrame(m_size, _cfg->LibavGray ? CV_8UC1 : CV_8UC3);
+				for (int i = 0; i < m_frame_stride; i++) {
+					if (!m_decoder->read(*frame)) {
+						return std::make_shared<cv::Mat>();
+					}
+				}
+				return frame;
+			}
+
+			virtual bool nextFrame_impl() override {
+				// frames were served from the cache, the decoder is not behind the current frame
+				if (m_decoderMoved) {
+					m_decoder->seek(this->currentFrameNumber() + 1);
+					m_decoderMoved = false;
+				}
+				std::shared_ptr<cv::Mat> mat = decodeFrame();
+				this->set_current_frame(mat);
+				if (m_recording) {
+					if (vCoder) vCoder->add(mat);
+				}
+				return !mat->empty();
+			}
+
+			virtual bool setFrameNumber_impl(size_t frame_number) override {
+				if (this->currentFrameNumber() + 1 != frame_number || m_decoderMoved) {
+					m_decoder->seek(frame_number);
+					m_decoderMoved = false;
+				}
+				return this->nextFrame_impl();
+			}
+
+			virtual void frameServedFromCache(size_t) override {
+				m_decoderMoved = true;
+			}
+
+			/**
+			* @return the index, nullptr if it is disabled or not built yet
+			*/
+			const VideoIndex *seekIndex() const {
+				if (!m_index && m_indexBuild.valid()
+					&& m_indexBuild.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+					m_index = m_indexBuild.get();
+				}
+				return m_index.get();
+			}
+
+			std::unique_ptr<LibavDecoder> m_decoder;
+			bool m_decoderMoved = false;
+			size_t m_num_frames = 0;
+			mutable std::shared_ptr<VideoIndex> m_index;
+			std::atomic<bool> m_cancelIndex{ false };
+			mutable std::future<std::shared_ptr<VideoIndex>> m_indexBuild;
+			cv::Size m_size;
+			std::string m_fileName;
+			std::vector<boost::filesystem::path> m_batch;
+			double m_fps = 0;
+			std::shared_ptr<VideoCoder> vCoder;
+			bool m_recording = false;
+		};
+#endif
+
+
+		/*********************************************************/
+
+
+		/**
+		* Presents the videos of a batch as one timeline with a global frame index.
+		* The first global frame of every file is kept in an offset table, a global frame is mapped to its file by
+		* binary search. Only the current file is open. The following file is opened (and its first frames decoded)
+		* in the background as soon as a file becomes current, so playback crosses file boundaries without a stall.
+		* The lengths start as the containers' estimates. With VideoSeekIndex the files are indexed in the background,
+		* the exact lengths replace the estimates as they come in (see applyCounts) and the file streams use these indices
+		* instead of building their own. A file ending before its estimate ends its segment there.
+		*/
+		class ImageStream3Timeline : public ImageStream {
+		public:
+			/**
+			* @throw file_not_found when a file does not exists
+			* @throw video_open_error when there is an error with a video
+			*/
+			explicit ImageStream3Timeline(Config *cfg, const std::vector<boost::filesystem::path> &files)
+				: ImageStream(0, cfg)
+				, m_files(files)
+			{
+				if (m_files.empty()) {
+					throw video_open_error("batch is empty");
+				}
+
+				for (const boost::filesystem::path &file : m_files) {
+					if (!boost::filesystem::exists(file)) {
+						throw file_not_found("Could not find file " + file.string());
+					}
+					m_counts.push_back(estimateFrames(file));
+				}
+				updateOffsets();
+
+				// every file is indexed once, by the counting below, and the file streams are handed its index
+				auto indices = std::make_shared<std::vector<std::promise<std::shared_ptr<VideoIndex>>>>(_cfg->VideoSeekIndex ? m_files.size() : 0);
+				for (std::promise<std::shared_ptr<VideoIndex>> &index : *indices) {
+					m_indices.push_back(index.get_future().share());
+				}
+
+				activate(0);
+				m_fps = _cfg->RecordFPS != -1 ? _cfg->RecordFPS : m_current->fps();
+				vCoder = std::make_shared<VideoCoder>(m_fps, _cfg);
+
+				// load first image
+				if (m_num_frames > 0) {
+					loadFrame(0);
+				}
+
+				if (!indices->empty()) {
+					m_counting = std::async(std::launch::async, [files = m_files, indices, cancel = &m_cancelCount]() {
+						// every promise is kept, a cancelled file has no index
+						for (size_t i = 0; i < files.size(); i++) {
+							(*indices)[i].set_value(*cancel ? nullptr : VideoIndex::open(files[i], cancel));
+						}
+					});
+				}
+			}
+			~ImageStream3Timeline() {
+				m_cancelCount = true;
+				if (m_counting.valid()) {
+					m_counting.wait();
+				}
+				if (m_next.valid()) {
+					m_next.wait();
+				}
+			}
+			virtual GuiParam::MediaType type() const override {
+				return GuiParam::MediaType::Video;
+			}
+			virtual size_t numFrames() const override {
+				return m_num_frames;
+			}
+			virtual bool toggleRecord() override {
+				const cv::Mat &frame = *this->currentFrame();
+				m_recording = vCoder->toggle(frame.cols, frame.rows, m_fps);
+				return m_recording;
+			}
+			virtual double fps() const override {
+				return m_fps;
+			}
+			virtual std::string currentFilename() const override {
+				return m_files[m_currentFile].string();
+			}
+			virtual std::vector<std::string> getBatchItems() override {
+				std::vector<std::string> batchItems;
+				for (auto x : m_files) {
+					batchItems.push_back(x.string());
+				}
+				return batchItems;
+			}
+
+		private:
+			virtual bool nextFrame_impl() override {
+				applyCounts(m_currentFile);
+				return loadFrame(this->currentFrameNumber() + m_frame_stride);
+			}
+			virtual bool previousFrame_impl() override {
+				applyCounts(m_currentFile);
+				return loadFrame(this->currentFrameNumber() - 1);
+			}
+			virtual bool setFrameNumber_impl(size_t frame_number) override {
+				// a seek starts from a new position, every count can be applied
+				applyCounts(0);
+				return loadFrame(frame_number);
+			}
+
+			/**
+			* @return the container's estimate of the frame count, it does not decode anything
+			*/
+			size_t estimateFrames(const boost::filesystem::path &file) const {
+				cv::VideoCapture probe(file.string());
+				if (!probe.isOpened()) {
+					throw video_open_error("Could not open video " + file.string());
+				}
+				return static_cast<size_t>(std::max(probe.get(cv::CAP_PROP_FRAME_COUNT), 0.0));
+			}
+
+			void updateOffsets() {
+				m_offsets.clear();
+				size_t offset = 0;
+				for (size_t count : m_counts) {
+					m_offsets.push_back(offset);
+					offset += count;
+				}
+				m_num_frames = offset;
+			}
+
+			/**
+			* @return the exact frame count of file, 0 while it is not counted (or can not be)
+			*/
+			size_t exactCount(size_t file) const {
+				if (file >= m_indices.size() || m_indices[file].wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+					return 0;
+				}
+				const std::shared_ptr<VideoIndex> &index = m_indices[file].get();
+				return index ? index->numFrames() : 0;
+			}
+
+			/**
+			* Replaces the estimates by the exact counts counted so far, for the files from first on.
+			* The counts of files before the current one move the current global frame number, they are applied on a seek.
+			*/
+			void applyCounts(size_t first) {
+				bool changed = false;
+				for (size_t i = first; i < m_counts.size(); i++) {
+					const size_t exact = exactCount(i);
+					if (exact > 0 && exact != m_counts[i]) {
+						m_counts[i] = exact;
+						changed = true;
+					}
+				}
+				if (changed) {
+					updateOffsets();
+				}
+			}
+
+			/**
+			* @return the index of the file holding the global frame (O(log files))
+			*/
+			size_t fileOf(size_t frame_number) const {
+				return static_cast<size_t>(std::upper_bound(m_offsets.begin(), m_offsets.end(), frame_number) - m_offsets.begin()) - 1;
+			}
+
+			std::shared_ptr<ImageStream> openFile(size_t file) {
+				return std::make_shared<ImageStream3Video>(_cfg, std::vector<boost::filesystem::path>{ m_files[file] },
+					file < m_indices.size() ? m_indices[file] : std::shared_future<std::shared_ptr<VideoIndex>>());
+			}
+
+			/**
+			* Makes file the current file, takes it from the background open if possible.
+			*/
+			void activate(size_t file) {
+				if (m_current && m_currentFile == file) {
+					return;
+				}
+				std::shared_ptr<ImageStream> stream;
+				if (m_next.valid()) {
+					std::shared_ptr<ImageStream> next = m_next.get();
+					if (m_nextFile == file) {
+						stream = next;
+					}
+				}
+				m_current = stream ? stream : openFile(file);
+				m_currentFile = file;
+
+				if (file + 1 < m_files.size()) {
+					m_nextFile = file + 1;
+					m_next = std::async(std::launch::async, [this](size_t next) {
+						try {
+							return openFile(next);
+						}
+						catch (const std::exception &) {
+							// reported when the file becomes current
+							return std::shared_ptr<ImageStream>();
+						}
+					}, m_nextFile);
+				}
+			}
+
+			bool loadFrame(size_t frame_number) {
+				if (frame_number >= m_num_frames) {
+					this->set_current_frame(std::make_shared<cv::Mat>());
+					return false;
+				}
+				const size_t file = fileOf(frame_number);
+				const size_t local = frame_number - m_offsets[file];
+				activate(file);
+
+				// step sequentially where possible, so the file's prefetcher and reverse chunks are used
+				const size_t position = m_current->currentFrameNumber();
+				bool success;
+				if (local == position) {
+					success = !m_current->currentFrameIsEmpty();
+				}
+				else if (local == position + m_frame_stride) {
+					success = m_current->nextFrame();
+				}
+				else if (local + 1 == position) {
+					success = m_current->previousFrame();
+				}
+				else {
+					success = m_current->setFrameNumber(local);
+				}
+
+				std::shared_ptr<cv::Mat> mat = m_current->currentFrame();
+				if (!mat || mat->empty()) {
+					if (frame_number < this->currentFrameNumber()) {
+						// going back into the (estimated) tail of a file: its last frame stands in until the next seek
+						const size_t exact = exactCount(file);
+						for (size_t last = exact ? std::min(local, exact) : local; (!mat || mat->empty()) && last > 0; last--) {
+							m_current->setFrameNumber(last - 1);
+							mat = m_current->currentFrame();
+						}
+						success = mat && !mat->empty();
+					}
+					else if (local > 0 && local < m_counts[file]) {
+						// the file ended before its estimate: its segment ends here and the next one starts at this frame
+						m_counts[file] = local;
+						updateOffsets();
+						return loadFrame(frame_number);
+					}
+				}
+				if (!mat) {
+					mat = std::make_shared<cv::Mat>();
+				}
+				this->set_current_frame(mat);
+				if (m_recording) {
+					if (vCoder) vCoder->add(mat);
+				}
+				return success;
+			}
+
+			std::vector<boost::filesystem::path> m_files;
+			std::vector<size_t> m_counts;
+			std::vector<size_t> m_offsets;
+			size_t m_num_frames;
+			// the index of every file, from the counting thread (empty without VideoSeekIndex)
+			std::vector<std::shared_future<std::shared_ptr<VideoIndex>>> m_indices;
+			std::atomic<bool> m_cancelCount{ false };
+			std::future<void> m_counting;
+			double m_fps;
+			std::shared_ptr<VideoCoder> vCoder;
+			bool m_recording = false;
+			std::shared_ptr<ImageStream> m_current;
+			size_t m_currentFile = 0;
+			std::future<std::shared_ptr<ImageStream>> m_next;
+			size_t m_nextFile = 0;
+		};
+
+		/*********************************************************/
+
+
+		/**
+		* Plays a raw frame container (see RawFrameFile.h). The file is memory mapped and every frame is a
+		* cv::Mat header pointing into the mapping, so nothing is decoded or copied. The mapping is private
+		* (copy-on-write), consumers drawing into a frame neither crash nor modify the file.
+		*/
+		class ImageStream3Raw : public ImageStream {
+		public:
+			/**
+			* @throw file_not_found when the file does not exists
+			* @throw video_open_error when the file is no valid raw frame container
+			*/
+			explicit ImageStream3Raw(Config *cfg, const boost::filesystem::path &file)
+				: ImageStream(0, cfg)
+				, m_fileName(file.string())
+			{
+				if (!boost::filesystem::exists(file)) {
+					throw file_not_found("Could not find file " + file.string());
+				}
+				try {
+					boost::interprocess::file_mapping mapping(m_fileName.c_str(), boost::interprocess::read_only);
+					m_region = std::make_shared<boost::interprocess::mapped_region>(mapping, boost::interprocess::copy_on_write);
+				}
+				catch (const boost::interprocess::interprocess_exception &e) {
+					throw video_open_error("Could not map " + m_fileName + ": " + e.what());
+				}
+
+				const size_t size = m_region->get_size();
+				if (size < sizeof(RawFrameHeader)) {
+					throw video_open_error(m_fileName + " is no raw frame file");
+				}
+				std::memcpy(&m_header, m_region->get_address(), sizeof(RawFrameHeader));
+				if (std::memcmp(m_header.magic, RAW_FRAME_MAGIC, sizeof(m_header.magic)) != 0 || m_header.version != RAW_FRAME_VERSION) {
+					throw video_open_error(m_fileName + " is no raw frame file");
+				}
+				if (m_header.frameBytes != static_cast<uint64_t>(m_header.width) * m_header.height * CV_ELEM_SIZE(m_header.type)
+					|| m_header.dataOffset + m_header.frameCount * m_header.frameBytes > size
+					|| (m_header.timestampOffset != 0 && m_header.timestampOffset + m_header.frameCount * sizeof(int64_t) > size)) {
+					throw video_open_error(m_fileName + " is truncated or corrupt");
+				}
+
+				m_fps = _cfg->RecordFPS != -1 ? _cfg->RecordFPS : m_header.fps;
+				vCoder = std::make_shared<VideoCoder>(m_fps, _cfg);
+
+				// load first image
+				if (m_header.frameCount > 0) {
+					loadFrame(0);
+				}
+			}
+			virtual GuiParam::MediaType type() const override {
+				return GuiParam::MediaType::Video;
+			}
+			virtual size_t numFrames() const override {
+				return static_cast<size_t>(m_header.frameCount);
+			}
+			virtual bool toggleRecord() override {
+				m_recording = vCoder->toggle(m_header.width, m_header.height, m_fps);
+				return m_recording;
+			}
+			virtual double fps() const override {
+				return m_fps;
+			}
+			virtual std::string currentFilename() const override {
+				return m_fileName;
+			}
+
+			/**
+			* @return the timestamp of the frame in microseconds since the start of the source, -1 if the file has none
+			*/
+			int64_t frameTimestamp(size_t frame_number) const {
+				if (m_header.timestampOffset == 0 || frame_number >= m_header.frameCount) {
+					return -1;
+				}
+				int64_t timestamp;
+				std::memcpy(&timestamp, static_cast<const char *>(m_region->get_address()) + m_header.timestampOffset
+					+ frame_number * sizeof(int64_t), sizeof(int64_t));
+				return timestamp;
+			}
+
+		private:
+			virtual bool nextFrame_impl() override {
+				return loadFrame(this->currentFrameNumber() + m_frame_stride);
+			}
+			virtual bool previousFrame_impl() override {
+				return loadFrame(this->currentFrameNumber() - 1);
+			}
+			virtual bool setFrameNumber_impl(size_t frame_number) override {
+				return loadFrame(frame_number);
+			}
+
+			bool loadFrame(size_t frame_number) {
+				if (frame_number >= m_header.frameCount) {
+					this->set_current_frame(std::make_shared<cv::Mat>());
+					return false;
+				}
+				char *data = static_cast<char *>(m_region->get_address()) + m_header.dataOffset + frame_number * m_header.frameBytes;
+				// the frame keeps the mapping alive, it may outlive the stream (e.g. in the encoder queue)
+				std::shared_ptr<boost::interprocess::mapped_region> region = m_region;
+				std::shared_ptr<cv::Mat> mat(new cv::Mat(static_cast<int>(m_header.height), static_cast<int>(m_header.width), m_header.type, data),
+					[region](cv::Mat *m) { delete m; });
+				this->set_current_frame(mat);
+				if (m_recording) {
+					if (vCoder) vCoder->add(mat);
+				}
+				return true;
+			}
+
+			std::string m_fileName;
+			std::shared_ptr<boost::interprocess::mapped_region> m_region;
+			RawFrameHeader m_header;
+			std::shared_ptr<VideoCoder> vCoder;
+			double m_fps;
+			bool m_recording = false;
+		};
+
+
+		/*********************************************************/
+
+
+		/**
+		* Serves procedurally rendered frames of a SyntheticScene, e.g. as load generator for benchmarks.
+		* Frames are rendered on demand into pooled buffers, so seeking is as cheap as playing.
+		*/
+		class ImageStream3Synthetic : public ImageStream {
+		public:
+			explicit ImageStream3Synthetic(Config *cfg, const SyntheticConfiguration &conf)
+				: ImageStream(0, cfg)
+				, m_scene(conf)
+			{
+				if (!conf.groundTruth.empty() && !m_scene.writeGroundTruth(conf.groundTruth)) {
+					qWarning() << "Could not write ground truth to" << QString::fromStdString(conf.groundTruth);
+				}
+				m_fps = _cfg->RecordFPS != -1 ? _cfg->RecordFPS : conf.fps;
+				vCoder = std::make_shared<VideoCoder>(m_fps, _cfg);
+
+				// load first image
+				if (conf.frames > 0) {
+					loadFrame(0);
+				}
+			}
+			virtual GuiParam::MediaType type() const override {
+				return GuiParam::MediaType::Video;
+			}
+			virtual size_t numFrames() const override {
+				return m_scene.configuration().frames;
+			}
+			virtual bool toggleRecord() override {
+				m_recording = vCoder->toggle(m_scene.configuration().width, m_scene.configuration().height, m_fps);
+				return m_recording;
+			}
+			virtual double fps() const override {
+				return m_fps;
+			}
+			virtual std::string currentFilename() const override {
+				return "synthetic-" + std::to_string(m_scene.configuration().seed);
+			}
+
+			/**
+			* @return the ground truth of frame_number
+			*/
+			std::vector<SyntheticObject> groundTruth(size_t frame_number) const {
+				return m_scene.objects(frame_number);
+			}
+
+		private:
+			virtual bool nextFrame_impl() override {
+				return loadFrame(this->currentFrameNumber() + m_frame_stride);
+			}
+			virtual bool previousFrame_impl() override {
+				return loadFrame(this->currentFrameNumber() - 1);
+			}
+			virtual bool setFrameNumber_impl(size_t frame_number) override {
+				return loadFrame(frame_number);
+			}
+
+			bool loadFrame(size_t frame_number) {
+				const SyntheticConfiguration &conf = m_scene.configuration();
+				std::shared_ptr<cv::Mat> mat = acquireFrame(cv::Size(conf.width, conf.height), CV_8UC3);
+				m_scene.render(frame_number, *mat);
+				this->set_current_frame(mat);
+				if (m_recording) {
+					if (vCoder) vCoder->add(mat);
+				}
+				return true;
+			}
+
+			SyntheticScene m_scene;
+			double m_fps;
+			std::shared_ptr<VideoCoder> vCoder;
+			bool m_recording = false;
+		};
+
+		/*********************************************************/
+
+
+		/**
+		* Live stream of the images written into a directory by external capture software, see DirectoryFrameSource.
+		*/
+		class ImageStream3Directory : public ImageStream {
+		public:
+			/**
+			* @throw directory_not_found when the directory does not exist
+			*/
+			explicit ImageStream3Directory(Config *cfg, const boost::filesystem::path &directory)
+				: ImageStream(0, cfg)
+				, m_directory(directory.string())
+				, m_source(directory, static_cast<size_t>(std::max(cfg->WatchBacklog, 1)),
+					static_cast<DirectoryFrameSource::DropPolicy>(std::min(std::max(cfg->WatchDropPolicy, 0), 2)),
+					std::chrono::milliseconds(std::max(cfg->WatchMaxLatencyMs, 0)))
+				, m_timeout(std::max(cfg->WatchTimeoutMs, 1))
+				, m_fps(cfg->RecordFPS != -1 ? cfg->RecordFPS : 30)
+			{
+				vCoder = std::make_shared<VideoCoder>(m_fps, _cfg);
+			}
+			virtual GuiParam::MediaType type() const override {
+				return GuiParam::MediaType::Camera;
+			}
+			virtual size_t numFrames() const override {
+				return -1;
+			}
+			virtual bool toggleRecord() override {
+				const cv::Mat &frame = *this->currentFrame();
+				if (frame.empty()) {
+					return false;
+				}
+				m_recording = vCoder->toggle(frame.cols, frame.rows, m_fps);
+				return m_recording;
+			}
+			virtual double fps() const override {
+				return m_fps;
+			}
+			virtual std::string currentFilename() const override {
+				return m_filename.empty() ? m_directory : m_filename;
+			}
+
+			virtual CaptureRing::Statistics captureStatistics() const override {
+				CaptureRing::Statistics statistics;
+				statistics.dropped = m_source.dropped();
+				return statistics;
+			}
+			virtual bool sourceEnded() const override {
+				return !boost::filesystem::is_directory(m_directory);
+			}
+
+		private:
+			virtual bool nextFrame_impl() override {
+				// an empty frame is delivered if nothing arrived in time, so the player stays responsive
+				DirectoryFrameSource::Frame frame;
+				for (int i = 0; i < m_frame_stride; i++) {
+					if (!m_source.pop(frame, m_timeout)) {
+						this->set_current_frame(std::make_shared<cv::Mat>());
+						return false;
+					}
+				}
+				m_filename = frame.filename;
+				this->set_current_frame(frame.image);
+				this->setCaptureTime(frame.detected);
+				if (m_recording) {
+					if (vCoder) vCoder->add(frame.image);
+				}
+				return true;
+			}
+
+			virtual bool setFrameNumber_impl(size_t) override {
+				return this->nextFrame_impl();
+			}
+
+			std::string m_directory;
+			std::string m_filename;
+			DirectoryFrameSource m_source;
+			std::chrono::milliseconds m_timeout;
+			double m_fps;
+			std::shared_ptr<VideoCoder> vCoder;
+			bool m_recording = false;
+		};
+
+		/*********************************************************/
+
+
+		/**
+		* Reads fixed size raw frames from a named pipe or stdin ("-"), e.g. from ffmpeg -f rawvideo.
+		* Every frame is read with a single read straight into a pooled buffer, there is no per-frame allocation or copy.
+		* The stream runs until the writer closes the pipe. A stalled writer blocks the player, like a camera.
+		*/
+		class ImageStream3Pipe : public ImageStream {
+		public:
+			/**
+			* @throw file_not_found when the pipe does not exist
+			* @throw video_open_error when the frame format is invalid
+			*/
+			explicit ImageStream3Pipe(Config *cfg, const boost::filesystem::path &pipe)
+				: ImageStream(0, cfg)
+				, m_name(pipe.string())
+				, m_size(cfg->PipeWidth, cfg->PipeHeight)
+				, m_fps(cfg->RecordFPS != -1 ? cfg->RecordFPS : 30)
+			{
+				const std::string format = cfg->PipeFormat.toLower().toStdString();
+				if (format == "gray" || format == "gray8") {
+					m_type = CV_8UC1;
+				}
+				else if (format == "bgr24" || format == "rgb24") {
+					m_type = CV_8UC3;
+					m_swapRB = format == "rgb24";
+				}
+				else {
+					throw video_open_error("Unsupported pipe pixel format " + format + " (gray, bgr24 or rgb24)");
+				}
+				if (m_size.area() <= 0) {
+					throw video_open_error("Pipe frame size has to be given with --pipeWidth and --pipeHeight");
+				}
+
+				if (m_name == "-") {
+#ifdef _WIN32
+					_setmode(_fileno(stdin), _O_BINARY);
+#endif
+					m_file = stdin;
+				}
+				else {
+					if (!boost::filesystem::exists(pipe)) {
+						throw file_not_found("Could not find pipe " + m_name);
+					}
+					// blocks until the writer opened the pipe
+					m_file = std::fopen(m_name.c_str(), "rb");
+					if (!m_file) {
+						throw video_open_error("Could not open pipe " + m_name);
+					}
+				}
+				// frames are read directly into the frame buffers, stdio buffering would only add a copy
+				std::setvbuf(m_file, nullptr, _IONBF, 0);
+				vCoder = std::make_shared<VideoCoder>(m_fps, _cfg);
+			}
+			~ImageStream3Pipe() {
+				if (m_file && m_file != stdin) {
+					std::fclose(m_file);
+				}
+			}
+			virtual GuiParam::MediaType type() const override {
+				return GuiParam::MediaType::Camera;
+			}
+			virtual size_t numFrames() const override {
+				return -1;
+			}
+			virtual bool toggleRecord() override {
+				m_recording = vCoder->toggle(m_size.width, m_size.height, m_fps);
+				return m_recording;
+			}
+			virtual double fps() const override {
+				return m_fps;
+			}
+			virtual std::string currentFilename() const override {
+				return m_name == "-" ? "stdin" : m_name;
+			}
+			virtual bool sourceEnded() const override {
+				return m_ended;
+			}
+
+		private:
+			virtual bool nextFrame_impl() override {
+				std::shared_ptr<cv::Mat> mat = acquireFrame(m_size, m_type);
+				const size_t bytes = mat->total() * mat->elemSize();
+				for (int i = 0; i < m_frame_stride; i++) {
+					if (std::fread(mat->data, 1, bytes, m_file) != bytes) {
+						// the writer closed the pipe (a partial frame is dropped)
+						m_ended = true;
+						this->set_current_frame(std::make_shared<cv::Mat>());
+						return false;
+					}
+				}
+				if (m_swapRB) {
+					cv::cvtColor(*mat, *mat, cv::COLOR_RGB2BGR);
+				}
+
+				this->set_current_frame(mat);
+				if (m_recording) {
+					if (vCoder) vCoder->add(mat);
+				}
+				return true;
+			}
+
+			virtual bool setFrameNumber_impl(size_t) override {
+				return this->nextFrame_impl();
+			}
+
+			std::string m_name;
+			std::FILE *m_file = nullptr;
+			cv::Size m_size;
+			int m_type = CV_8UC3;
+			bool m_swapRB = false;
+			bool m_ended = false;
+			double m_fps;
+			std::shared_ptr<VideoCoder> vCoder;
+			bool m_recording = false;
+		};
+
+		/*********************************************************/
+
+
+		/**
+		* Attaches to a frame ring in shared memory filled by another process (see SharedFrameRing).
+		* Frames are views into the segment. The deleter of every frame keeps the mapping alive.
+		* With Config::SharedMemoryCopy they are copied into pooled buffers instead, for producers that may lap the consumer.
+		* Like the camera, the newest frame is delivered, or every frame in order with Config::CaptureLossless.
+		* A ring created for several consumers (see SweepRunner) hands each of them every frame: the stream claims a cursor,
+		* copies every frame and releases its slot. It ends when the producer closes the ring.
+		*/
+		class ImageStream3SharedMemory : public ImageStream {
+		public:
+			/**
+			* @throw device_open_error when there is no frame ring of that name
+			*/
+			explicit ImageStream3SharedMemory(Config *cfg, const std::string &name)
+				: ImageStream(0, cfg)
+				, m_name(name)
+				, m_fps(cfg->RecordFPS != -1 ? cfg->RecordFPS : 30)
+			{
+				try {
+					m_ring = SharedFrameRing::attach(name, true);
+				}
+				catch (const std::runtime_error &e) {
+					throw device_open_error(e.what());
+				}
+				// a cursor starts at the first frame, others get only frames published from now on
+				m_next = m_ring->isConsumer() ? 0 : m_ring->published();
+				vCoder = std::make_shared<VideoCoder>(m_fps, _cfg);
+				// like a video it opens at its first frame, so the frame numbers are the producer's
+				if (m_ring->isConsumer()) {
+					deliver(1);
+				}
+			}
+			virtual GuiParam::MediaType type() const override {
+				return GuiParam::MediaType::Camera;
+			}
+			virtual size_t numFrames() const override {
+				return -1;
+			}
+			virtual bool toggleRecord() override {
+				const cv::Mat &frame = *this->currentFrame();
+				if (frame.empty()) {
+					return false;
+				}
+				m_recording = vCoder->toggle(frame.cols, frame.rows, m_fps);
 				return m_recording;
 			}
 			virtual double fps() const override {
 				return m_fps;
 			}
 			virtual std::string currentFilename() const override {
-				assert(currentFrameNumber() < m_picture_files.size());
-				return m_picture_files[currentFrameNumber()].string();
+				return m_name;
+			}
+			virtual CaptureRing::Statistics captureStatistics() const override {
+				return m_statistics;
+			}
+			virtual bool sourceEnded() const override {
+				// every frame published before the ring was closed is delivered first
+				return m_ring->closed() && m_ring->published() == m_next;
 			}
 
 		private:
-			virtual bool nextFrame_impl() override {
-				m_currentFrame += static_cast<int>(m_frame_stride);
-				if (this->numFrames() > m_currentFrame) {
+			/**
+			* Waits for the next frame to deliver.
+			*/
+			bool acquire(uint32_t &n, cv::Mat &view, int64_t &timestamp) {
+				// the producer of a cursor waits for its other consumers, it is only given up on when it is gone
+				const auto timeout = m_ring->isConsumer() ? std::chrono::milliseconds(60000) : std::chrono::milliseconds(1000);
+				const auto deadline = std::chrono::steady_clock::now() + timeout;
+				for (;;) {
+					// the ring is closed after its last frame is published
+					const bool closed = m_ring->closed();
+					const uint32_t published = m_ring->published();
+					if (published == m_next) {
+						const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+						if (closed || left.count() <= 0 || !m_ring->waitForPublished(m_next, left)) {
+							return false;
+						}
+						continue;
+					}
 
-					const std::string &filename = m_picture_files[m_currentFrame].string();
-					std::shared_ptr<cv::Mat> new_frame = std::make_shared<cv::Mat>(cv::imread(filename));
-					this->set_current_frame(new_frame);
-					if (m_recording) {
-						if (vCoder) vCoder->add(new_frame);
+					if (m_ring->isConsumer()) {
+						// the slot is not overwritten before this cursor releases it
+						n = m_next++;
+						if (m_ring->read(n, view, timestamp)) {
+							return true;
+						}
+						m_statistics.dropped++;
+						continue;
 					}
-					return true;
+
+					// unsigned differences, the counter may wrap. The slot written next is not safe to read.
+					const uint32_t safe = std::max<uint32_t>(m_ring->slotCount() - 1, 1);
+					const uint32_t oldest = published - m_next > safe ? published - safe : m_next;
+					n = _cfg->CaptureLossless ? oldest : published - 1;
+					m_statistics.dropped += n - m_next;
+					m_next = n + 1;
+					if (m_ring->read(n, view, timestamp)) {
+						return true;
+					}
+					// overwritten in the meantime
+					m_statistics.dropped++;
 				}
-				return false;
 			}
 
-			virtual bool setFrameNumber_impl(size_t frame_number) override {
-				const std::string &filename = m_picture_files[frame_number].string();
-				std::shared_ptr<cv::Mat> new_frame = std::make_shared<cv::Mat>(cv::imread(filename));
-				this->set_current_frame(new_frame);
-				m_currentFrame = static_cast<int>(frame_number);
+			/**
+			* Delivers the count-th next frame.
+			*/
+			bool deliver(int count) {
+				uint32_t n = 0;
+				cv::Mat view;
+				int64_t timestamp = 0;
+				for (int i = 0; i < count; i++) {
+					if (!acquire(n, view, timestamp)) {
+						// an empty frame is delivered if the producer stalls, so the player stays responsive
+						this->set_current_frame(std::make_shared<cv::Mat>());
+						return false;
+					}
+					// frames skipped by the stride are released right away
+					if (i + 1 < count) {
+						m_ring->release(n);
+					}
+				}
+
+				std::shared_ptr<cv::Mat> mat;
+				if (_cfg->SharedMemoryCopy || m_ring->isConsumer()) {
+					mat = acquireFrame(view.size(), view.type());
+					view.copyTo(*mat);
+					m_ring->release(n);
+				}
+				else {
+					std::shared_ptr<SharedFrameRing> ring = m_ring;
+					mat = std::shared_ptr<cv::Mat>(new cv::Mat(view), [ring](cv::Mat *m) { delete m; });
+				}
+
+				this->set_current_frame(mat);
+				m_statistics.captured++;
+				m_statistics.delivered++;
+				if (timestamp > 0) {
+					// steady_clock is CLOCK_MONOTONIC, shared by all processes of the machine
+					const FrameDescriptor::Clock::time_point captured{ std::chrono::duration_cast<FrameDescriptor::Clock::duration>(std::chrono::microseconds(timestamp)) };
+					this->setCaptureTime(captured);
+					m_statistics.ageMs = std::chrono::duration<double, std::milli>(FrameDescriptor::Clock::now() - captured).count();
+					m_statistics.maxAgeMs = std::max(m_statistics.maxAgeMs, m_statistics.ageMs);
+				}
 				if (m_recording) {
-					if (vCoder) vCoder->add(new_frame);
+					if (vCoder) vCoder->add(mat);
 				}
-				return !new_frame->empty();
+				return true;
 			}
-			std::vector<boost::filesystem::path> m_picture_files;
-			std::shared_ptr<VideoCoder> vCoder;
-			double m_w;
-			double m_h;
-			bool m_recording;
-			int m_currentFrame;
+
+			virtual bool nextFrame_impl() override {
+				return deliver(m_frame_stride);
+			}
+
+			virtual bool setFrameNumber_impl(size_t) override {
+				return this->nextFrame_impl();
+			}
+
+			std::string m_name;
+			std::shared_ptr<SharedFrameRing> m_ring;
+			uint32_t m_next = 0;
+			CaptureRing::Statistics m_statistics;
 			double m_fps;
+			std::shared_ptr<VideoCoder> vCoder;
+			bool m_recording = false;
 		};
 
-
 		/*********************************************************/
 
 
-		class ImageStream3Video : public ImageStream {
+		/**
+		* Plays several synchronized sources (e.g. cameras filming the same arena) as one stream.
+		* Every source is decoded by its own worker thread, the frames are composed into one frame:
+		* a grid mosaic or, for trackers handling the sources separately, a stack of equally sized
+		* tiles that can be split with cv::Mat::rowRange.
+		* The sources are aligned by frame index or by timestamp, the latter for sources with different frame rates.
+		* Timestamps are the capture timestamps of raw containers and the demuxed presentation timestamps of videos
+		* (from the keyframe index, with libav). Without them they are derived from the frame rate.
+		*/
+		class ImageStream3Composite : public ImageStream {
 		public:
 			/**
-			* @throw file_not_found when the file does not exists
-			* @throw video_open_error when there is an error with the video
-			* @brief ImageStreamVideo
-			* @param filename path to the file
+			* @throw file_not_found when a file does not exists
+			* @throw video_open_error when there is an error with a source
 			*/
-			explicit ImageStream3Video(Config *cfg, const std::vector<boost::filesystem::path> &files) 
+			explicit ImageStream3Composite(Config *cfg, const std::vector<boost::filesystem::path> &files)
 				: ImageStream(0, cfg)
+				, m_files(files)
+				, m_byTimestamp(cfg->CompositeSync != 0)
 			{
-				openMedia(files);
+				if (m_files.empty()) {
+					throw video_open_error("composite has no sources");
+				}
+
+				// sources are opened in parallel as well, building their indexes may take a while
+				std::vector<std::future<std::unique_ptr<Source>>> opened;
+				for (const boost::filesystem::path &file : m_files) {
+					if (!boost::filesystem::exists(file)) {
+						throw file_not_found("Could not find file " + file.string());
+					}
+					opened.push_back(std::async(std::launch::async, [this, file]() {
+						std::unique_ptr<Source> source(new Source());
+						if (isRawFrameFile(file)) {
+							source->stream = std::make_shared<ImageStream3Raw>(_cfg, file);
+						}
+						else {
+							source->stream = std::make_shared<ImageStream3Video>(_cfg, std::vector<boost::filesystem::path>{ file });
+						}
+						if (source->stream->currentFrameIsEmpty()) {
+							throw video_open_error("Could not read from " + file.string());
+						}
+						if (m_byTimestamp) {
+							source->timestamps = timestamps(*source->stream);
+						}
+						return source;
+					}));
+				}
+
+				m_fps = 0;
+				cv::Size tile;
+				for (size_t i = 0; i < opened.size(); i++) {
+					std::unique_ptr<Source> source = opened[i].get();
+					tile.width = std::max(tile.width, source->stream->currentFrame()->cols);
+					tile.height = std::max(tile.height, source->stream->currentFrame()->rows);
+					m_fps = std::max(m_fps, source->stream->fps());
+					m_sources.push_back(std::move(source));
+				}
+				if (m_fps <= 0) {
+					m_fps = 25;
+				}
+
+				updateNumFrames();
+
+				const int count = static_cast<int>(m_sources.size());
+				const int columns = cfg->CompositeLayout ? 1 : static_cast<int>(std::ceil(std::sqrt(count)));
+				const int rows = (count + columns - 1) / columns;
+				m_size = cv::Size(tile.width * columns, tile.height * rows);
+				for (int i = 0; i < count; i++) {
+					m_sources[i]->tile = cv::Rect((i % columns) * tile.width, (i / columns) * tile.height, tile.width, tile.height);
+				}
+
+				for (const std::unique_ptr<Source> &source : m_sources) {
+					source->worker = std::thread(&ImageStream3Composite::run, this, source.get());
+				}
+
+				if (_cfg->RecordFPS != -1) {
+					m_fps = _cfg->RecordFPS;
+				}
+				vCoder = std::make_shared<VideoCoder>(m_fps, _cfg);
+
+				// load first image
+				if (m_num_frames > 0) {
+					loadFrame(0);
+				}
+			}
+			~ImageStream3Composite() {
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					m_running = false;
+				}
+				m_work.notify_all();
+				for (const std::unique_ptr<Source> &source : m_sources) {
+					if (source->worker.joinable()) {
+						source->worker.join();
+					}
+				}
 			}
 			virtual GuiParam::MediaType type() const override {
 				return GuiParam::MediaType::Video;
@@ -277,113 +1980,227 @@ namespace BioTracker {
 				return m_num_frames;
 			}
 			virtual bool toggleRecord() override {
-				if (!m_capture.isOpened()) {
-					return false;
-				}
-				m_recording = vCoder->toggle(m_w, m_h, m_fps);
-
+				m_recording = vCoder->toggle(m_size.width, m_size.height, m_fps);
 				return m_recording;
 			}
 			virtual double fps() const override {
 				return m_fps;
 			}
 			virtual std::string currentFilename() const override {
-				return m_fileName;
+				return m_files.front().string();
 			}
-			
-			virtual bool hasNextInBatch() override{
-				return !(m_batch.empty());
-			}
-
-			virtual void stepToNextInBatch() override{
-				if (m_batch.empty()) {
-					throw video_open_error("batch is empty");
-				}
-				openMedia(m_batch);
-			} 
 
-			virtual std::vector<std::string> getBatchItems() override{
-				std::vector<std::string> batchItems;
-				for (auto x: m_batch){
-					batchItems.push_back(x.string());
-				}
-				return batchItems;
+			/**
+			* @return the region of the composed frame holding source i
+			*/
+			cv::Rect tile(size_t i) const {
+				return m_sources[i]->tile;
 			}
 
 		private:
+			struct Source {
+				std::shared_ptr<ImageStream> stream;
+				std::vector<int64_t> timestamps;
+				cv::Rect tile;
+				std::thread worker;
+				size_t target = 0;
+				bool pending = false;
+				bool success = false;
+			};
 
-			void openMedia(std::vector<boost::filesystem::path> files){
-
-				m_capture.open(files.front().string());
-				m_num_frames = static_cast<size_t>(m_capture.get(cv::CAP_PROP_FRAME_COUNT));
-				m_fps = m_capture.get(cv::CAP_PROP_FPS);
-				m_fileName = files.front().string();
+			virtual bool nextFrame_impl() override {
+				return loadFrame(this->currentFrameNumber() + m_frame_stride);
+			}
+			virtual bool previousFrame_impl() override {
+				return loadFrame(this->currentFrameNumber() - 1);
+			}
+			virtual bool setFrameNumber_impl(size_t frame_number) override {
+				return loadFrame(frame_number);
+			}
 
-				if (!boost::filesystem::exists(files.front())) {
-					throw file_not_found("Could not find file " + files.front().string());
+			/**
+			* @return the timestamps of all frames of the stream in microseconds: capture timestamps of raw containers,
+			* presentation timestamps of videos if the keyframe index knows them, derived from the frame rate otherwise
+			*/
+			std::vector<int64_t> timestamps(ImageStream &stream) const {
+				ImageStream3Raw *raw = dynamic_cast<ImageStream3Raw *>(&stream);
+				std::shared_ptr<VideoIndex> index;
+#if HAS_LIBAV
+				// the index the video builds anyway is waited for. Without libav it knows no timestamps,
+				// waiting for it would decode the whole video
+				if (ImageStream3Video *video = dynamic_cast<ImageStream3Video *>(&stream)) {
+					std::shared_future<std::shared_ptr<VideoIndex>> build = video->index();
+					if (build.valid()) {
+						index = build.get();
+					}
 				}
-				if (!m_capture.isOpened()) {
-					throw video_open_error(":(");
+#endif
+				std::vector<int64_t> result(std::max<size_t>(index ? index->numFrames() : stream.numFrames(), 1));
+				const double fps = stream.fps() > 0 ? stream.fps() : 25;
+				for (size_t i = 0; i < result.size(); i++) {
+					int64_t known = -1;
+					if (raw) {
+						known = raw->frameTimestamp(i);
+					}
+					else if (index) {
+						known = index->timestamp(i);
+					}
+					result[i] = known >= 0 ? known : static_cast<int64_t>(i * 1e6 / fps);
 				}
+				return result;
+			}
 
-                m_batch = files;
-                m_batch.erase(m_batch.begin(), m_batch.begin()+1);
+			/**
+			* Ends the composite with its shortest source. The lengths of videos become exact once their indices are built.
+			*/
+			void updateNumFrames() {
+				size_t frames = std::numeric_limits<size_t>::max();
+				for (const std::unique_ptr<Source> &source : m_sources) {
+					const size_t count = source->stream->numFrames();
+					if (m_byTimestamp) {
+						const size_t last = std::min(count, source->timestamps.size());
+						frames = last > 0 ? std::min(frames, static_cast<size_t>(source->timestamps[last - 1] * m_fps / 1e6) + 1) : 0;
+					}
+					else {
+						frames = std::min(frames, count);
+					}
+				}
+				m_num_frames = frames;
+			}
 
-                //Grab the fps from config file
-                double fps = _cfg->RecordFPS;
-                if (fps != -1) {
-                    m_fps = fps;
-                }
+			/**
+			* @return the frame of source shown at frame_number of the composite
+			*/
+			size_t localFrame(const Source &source, size_t frame_number) const {
+				if (!m_byTimestamp) {
+					return frame_number;
+				}
+				const int64_t time = static_cast<int64_t>(frame_number * 1e6 / m_fps);
+				auto it = std::upper_bound(source.timestamps.begin(), source.timestamps.end(), time);
+				return it == source.timestamps.begin() ? 0 : static_cast<size_t>(it - source.timestamps.begin()) - 1;
+			}
 
-				m_w = m_capture.get(cv::CAP_PROP_FRAME_WIDTH);
-				m_h = m_capture.get(cv::CAP_PROP_FRAME_HEIGHT);
-				m_recording = false;
-				vCoder = std::make_shared<VideoCoder>(m_fps, _cfg);
+			void run(Source *source) {
+				for (;;) {
+					std::shared_ptr<cv::Mat> target;
+					size_t frame_number;
+					{
+						std::unique_lock<std::mutex> lock(m_mutex);
+						m_work.wait(lock, [this, source] { return !m_running || source->pending; });
+						if (!m_running) {
+							return;
+						}
+						target = m_target;
+						frame_number = source->target;
+					}
 
-				// load first image
-				if (this->numFrames() > 0) {
-					this->nextFrame_impl();
-				}
+					// a source that ran out (e.g. shorter than estimated) leaves its tile blank
+					const bool success = step(*source->stream, frame_number, m_frame_stride);
+					const std::shared_ptr<cv::Mat> frame = source->stream->currentFrame();
+					compose(frame ? *frame : cv::Mat(), (*target)(source->tile));
 
-				m_current_frame_number = 0;
+					std::lock_guard<std::mutex> lock(m_mutex);
+					source->success = success;
+					source->pending = false;
+					if (--m_pending == 0) {
+						m_done.notify_all();
+					}
+				}
 			}
 
-			virtual bool nextFrame_impl() override {
-				cv::Mat new_frame;
-				for (int i = 0; i<m_frame_stride; i++)
-					m_capture >> new_frame;
-				std::shared_ptr<cv::Mat> mat(new cv::Mat(new_frame));
-				this->set_current_frame(mat);
-				if (m_recording) {
-					if (vCoder) vCoder->add(mat);
+			/**
+			* Steps sequentially where possible, so the source's prefetcher and reverse chunks are used.
+			*/
+			static bool step(ImageStream &stream, size_t frame_number, size_t stride) {
+				const size_t position = stream.currentFrameNumber();
+				if (frame_number == position) {
+					return !stream.currentFrameIsEmpty();
+				}
+				// the sources share the config, nextFrame steps by the same stride
+				if (frame_number == position + stride) {
+					return stream.nextFrame();
+				}
+				if (frame_number + 1 == position) {
+					return stream.previousFrame();
 				}
-				return !new_frame.empty();
+				return stream.setFrameNumber(frame_number);
 			}
 
-			virtual bool setFrameNumber_impl(size_t frame_number) override {
-				// new frame is next frame --> use next frame function
-				if (this->currentFrameNumber() + 1 == frame_number) {
-					return this->nextFrame_impl();
+			/**
+			* Writes frame into its tile, converting and scaling only if necessary.
+			*/
+			static void compose(const cv::Mat &frame, cv::Mat tile) {
+				if (frame.empty()) {
+					tile.setTo(cv::Scalar::all(0));
+					return;
+				}
+				cv::Mat converted = frame;
+				if (converted.depth() != CV_8U) {
+					converted.convertTo(converted, CV_8U);
+				}
+				if (converted.channels() == 1) {
+					cv::cvtColor(converted, converted, cv::COLOR_GRAY2BGR);
+				}
+				else if (converted.channels() == 4) {
+					cv::cvtColor(converted, converted, cv::COLOR_BGRA2BGR);
+				}
+				if (converted.size() == tile.size()) {
+					converted.copyTo(tile);
 				}
 				else {
-					// adjust frame position ("0-based index of the frame to be decoded/captured next.")
-					m_capture.set(cv::CAP_PROP_POS_FRAMES, static_cast<double>(frame_number));
-					return this->nextFrame_impl();
+					cv::resize(converted, tile, tile.size(), 0, 0, cv::INTER_AREA);
 				}
 			}
 
-			cv::VideoCapture m_capture;
-			size_t     m_num_frames;
-			std::string m_fileName;
-			std::shared_ptr<VideoCoder> vCoder;
-            std::vector<boost::filesystem::path> m_batch;
+			bool loadFrame(size_t frame_number) {
+				// the workers are idle, the sources can be asked
+				updateNumFrames();
+				if (frame_number >= m_num_frames) {
+					this->set_current_frame(std::make_shared<cv::Mat>());
+					return false;
+				}
+				std::shared_ptr<cv::Mat> mat = acquireFrame(m_size, CV_8UC3);
+
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_target = mat;
+				for (const std::unique_ptr<Source> &source : m_sources) {
+					source->target = localFrame(*source, frame_number);
+					source->pending = true;
+				}
+				m_pending = m_sources.size();
+				m_work.notify_all();
+				m_done.wait(lock, [this] { return m_pending == 0; });
+				m_target.reset();
+				bool success = true;
+				for (const std::unique_ptr<Source> &source : m_sources) {
+					success = success && source->success;
+				}
+				lock.unlock();
+
+				this->set_current_frame(mat);
+				if (m_recording) {
+					if (vCoder) vCoder->add(mat);
+				}
+				return success;
+			}
+
+			std::vector<boost::filesystem::path> m_files;
+			std::vector<std::unique_ptr<Source>> m_sources;
+			bool m_byTimestamp;
+			size_t m_num_frames;
+			cv::Size m_size;
 			double m_fps;
-			double m_w;
-			double m_h;
-			bool m_recording;
+			std::shared_ptr<VideoCoder> vCoder;
+			bool m_recording = false;
+
+			std::mutex m_mutex;
+			std::condition_variable m_work;
+			std::condition_variable m_done;
+			std::shared_ptr<cv::Mat> m_target;
+			size_t m_pending = 0;
+			bool m_running = true;
 		};
 
-
 		/*********************************************************/
 		class ImageStream3OpenCVCamera : public ImageStream {
 		public:
@@ -430,6 +2247,14 @@ namespace BioTracker {
 				m_h = m_capture.get(cv::CAP_PROP_FRAME_HEIGHT);
 				m_fps = m_capture.get(cv::CAP_PROP_FPS);
 				qDebug() << "Cam open: " << m_capture.isOpened() << " w/h:" << m_w << "/" << m_h << " fps:" << m_fps;
+
+				// grab continuously, so slow tracking does not make the driver queue up stale frames
+				m_ring.reset(new CaptureRing([this]() {
+					std::shared_ptr<cv::Mat> mat = acquireFrame(cv::Size(static_cast<int>(m_w), static_cast<int>(m_h)), CV_8UC3);
+					m_capture >> *mat;
+					return mat;
+				}, static_cast<size_t>(std::max(_cfg->CaptureRingFrames, 1)), _cfg->CaptureLossless != 0));
+
 				// load first image
 				if (this->numFrames() > 0) {
 					this->nextFrame_impl();
@@ -455,22 +2280,28 @@ namespace BioTracker {
 			virtual std::string currentFilename() const override {
 				return "Camera"; // TODO be more specific!
 			}
+			virtual CaptureRing::Statistics captureStatistics() const override {
+				return m_ring ? m_ring->statistics() : CaptureRing::Statistics();
+			}
 
 		private:
 
 			virtual bool nextFrame_impl() override {
-				cv::Mat new_frame;
-
+				// an empty frame is delivered if the camera stalls, so the player stays responsive
+				CaptureRing::Frame frame;
 				for (int i = 0; i < m_frame_stride; i++) {
-					m_capture >> new_frame;
+					if (!m_ring->pop(frame, std::chrono::milliseconds(1000))) {
+						this->set_current_frame(std::make_shared<cv::Mat>());
+						return false;
+					}
 				}
 
-				std::shared_ptr<cv::Mat> mat(new cv::Mat(new_frame));
-				this->set_current_frame(mat);
+				this->set_current_frame(frame.image);
+				this->setCaptureTime(frame.captured);
 				if (m_recording) {
-					if (vCoder) vCoder->add(mat);
+					if (vCoder) vCoder->add(frame.image);
 				}
-				return !mat->empty();
+				return true;
 			}
 
 			virtual bool setFrameNumber_impl(size_t) override {
@@ -485,6 +2316,8 @@ namespace BioTracker {
 			double m_w;
 			double m_h;
 			bool m_recording;
+			// declared after m_capture: the capture thread is stopped before the device is released
+			std::unique_ptr<CaptureRing> m_ring;
 		};
 
 #if HAS_PYLON
@@ -634,11 +2467,19 @@ namespace BioTracker {
 				}
 
 				auto view = toOpenCV(grabbed);
-				auto scaled = std::make_shared<cv::Mat>();
-				cv::resize(view, *scaled, m_imageSize);
-				if (scaled->type() == CV_8UC1)
-            		cv::cvtColor(*scaled, *scaled, cv::COLOR_GRAY2BGR);
-				set_current_frame(scaled);
+				auto scaled = acquireFrame(m_imageSize, CV_8UC3);
+				if (view.type() == CV_8UC1) {
+					// the native single channel frame is kept for the tracker, only the display gets BGR
+					auto gray = acquireFrame(m_imageSize, CV_8UC1);
+					cv::resize(view, *gray, m_imageSize);
+					cv::cvtColor(*gray, *scaled, cv::COLOR_GRAY2BGR);
+					set_current_frame(scaled);
+					setCurrentGrayFrame(gray);
+				}
+				else {
+					cv::resize(view, *scaled, m_imageSize);
+					set_current_frame(scaled);
+				}
 				if (m_recording && m_encoder)
 					m_encoder->add(scaled);
 
@@ -692,6 +2533,13 @@ namespace BioTracker {
 
 		std::shared_ptr<ImageStream> make_ImageStream3Video(Config *cfg, const std::vector<boost::filesystem::path> &files) {
 			try {
+				if (cfg->VideoBackend == 1) {
+#if HAS_LIBAV
+					return std::make_shared<ImageStream3LibavVideo>(cfg, files);
+#else
+					qWarning() << "BioTracker is built without libav support, decoding with OpenCV";
+#endif
+				}
 				return std::make_shared<ImageStream3Video>(cfg, files);
 			}
 			catch (const video_open_error &) {
@@ -699,6 +2547,70 @@ namespace BioTracker {
 			}
 		}
 
+		std::shared_ptr<ImageStream> make_ImageStream3Timeline(Config *cfg, const std::vector<boost::filesystem::path> &files) {
+			try {
+				return std::make_shared<ImageStream3Timeline>(cfg, files);
+			}
+			catch (const std::invalid_argument &e) {
+				qWarning() << e.what();
+				return make_ImageStream3NoMedia();
+			}
+		}
+
+		std::shared_ptr<ImageStream> make_ImageStream3Composite(Config *cfg, const std::vector<boost::filesystem::path> &files) {
+			try {
+				return std::make_shared<ImageStream3Composite>(cfg, files);
+			}
+			catch (const std::invalid_argument &e) {
+				qWarning() << e.what();
+				return make_ImageStream3NoMedia();
+			}
+		}
+
+		std::shared_ptr<ImageStream> make_ImageStream3Raw(Config *cfg, const boost::filesystem::path &file) {
+			try {
+				return std::make_shared<ImageStream3Raw>(cfg, file);
+			}
+			catch (const std::invalid_argument &e) {
+				qWarning() << e.what();
+				return make_ImageStream3NoMedia();
+			}
+		}
+
+		std::shared_ptr<ImageStream> make_ImageStream3Synthetic(Config *cfg, const SyntheticConfiguration &conf) {
+			return std::make_shared<ImageStream3Synthetic>(cfg, conf);
+		}
+
+		std::shared_ptr<ImageStream> make_ImageStream3Directory(Config *cfg, const boost::filesystem::path &directory) {
+			try {
+				return std::make_shared<ImageStream3Directory>(cfg, directory);
+			}
+			catch (const directory_not_found &e) {
+				qWarning() << e.what();
+				return make_ImageStream3NoMedia();
+			}
+		}
+
+		std::shared_ptr<ImageStream> make_ImageStream3Pipe(Config *cfg, const boost::filesystem::path &pipe) {
+			try {
+				return std::make_shared<ImageStream3Pipe>(cfg, pipe);
+			}
+			catch (const std::invalid_argument &e) {
+				qWarning() << e.what();
+				return make_ImageStream3NoMedia();
+			}
+		}
+
+		std::shared_ptr<ImageStream> make_ImageStream3SharedMemory(Config *cfg, const std::string &name) {
+			try {
+				return std::make_shared<ImageStream3SharedMemory>(cfg, name);
+			}
+			catch (const device_open_error &e) {
+				qWarning() << e.what();
+				return make_ImageStream3NoMedia();
+			}
+		}
+
 		std::shared_ptr<ImageStream> make_ImageStream3Camera(Config *cfg, CameraConfiguration conf) {
 			try {
 				switch (conf._selector.type) {
@@ -717,5 +2629,18 @@ namespace BioTracker {
 			}
 		}
 
+		std::shared_ptr<ImageStream> make_ImageStream3Files(Config *cfg, const std::vector<boost::filesystem::path> &files) {
+			if (!files.empty() && isRawFrameFile(files.front())) {
+				return make_ImageStream3Raw(cfg, files.front());
+			}
+			if (files.size() > 1 && cfg->CompositeSources) {
+				return make_ImageStream3Composite(cfg, files);
+			}
+			if (files.size() > 1 && cfg->BatchTimeline) {
+				return make_ImageStream3Timeline(cfg, files);
+			}
+			return make_ImageStream3Video(cfg, files);
+		}
+
 	}
 }
@@ -20,10 +20,16 @@
 #include "util/types.h"
 #include "util/camera/base.h"
 #include "util/Config.h"
+#include "Model/CaptureRing.h"
+#include "Model/FrameDescriptor.h"
+#include "Model/FramePool.h"
+#include "Model/SyntheticScene.h"
 
 namespace BioTracker {
 namespace Core {
 
+class FrameCache;
+
 /**
  * The ImageStream class was part of BioTracker version 2. It is responsible for generation ImageStreams from files or camera devices.
  */
@@ -116,6 +122,53 @@ class ImageStream : public QObject {
 
     virtual std::vector<std::string> getBatchItems();
 
+    /**
+     * @return the number of frames served from / missed in the decoded-frame cache (0 if the cache is disabled)
+     */
+    size_t frameCacheHits() const;
+    size_t frameCacheMisses() const;
+
+    /**
+     * @return allocation statistics of the stream's frame buffer pool
+     */
+    FramePool::Statistics framePoolStatistics() const;
+
+    /**
+     * @return capture statistics (dropped frames, frame age) of live streams, all zero for files
+     */
+    virtual CaptureRing::Statistics captureStatistics() const;
+
+    /**
+     * @return true if a live source will deliver no further frames, e.g. the writer closed the pipe.
+     * A failed nextFrame of a live source that did not end is a timeout. Files end at numFrames(), cameras never end.
+     */
+    virtual bool sourceEnded() const;
+
+    /**
+     * Restricts the frames handed to the tracker to a region of the full frame (e.g. the tracking area).
+     * An empty region disables cropping.
+     */
+    void setCropRegion(const cv::Rect &region);
+    cv::Rect cropRegion() const;
+
+    /**
+     * Delivers single channel frames to the tracker. The display still gets the frames in color.
+     */
+    void setTrackingGrayscale(bool grayscale);
+    bool trackingGrayscale() const;
+
+    /**
+     * @return the frame handed to the tracker: frame converted to grayscale (if enabled) and cropped to the
+     * crop region (if set). A crop shares the pixels of the full frame and keeps it alive. Its offset in the
+     * full frame travels with it and can be recovered with cv::Mat::locateROI.
+     */
+    std::shared_ptr<cv::Mat> trackingView(const std::shared_ptr<cv::Mat> &frame);
+
+    /**
+     * @return the descriptor of the current frame (sequence id, source frame number, capture and decode time)
+     */
+    FrameDescriptor currentDescriptor() const;
+
     virtual ~ImageStream();
 
   protected:
@@ -124,6 +177,11 @@ class ImageStream : public QObject {
      */
     void set_current_frame(std::shared_ptr<cv::Mat> img);
 
+    /**
+     * Sets the capture time of the current frame, for sources knowing it (cameras). Defaults to the decode time.
+     */
+    void setCaptureTime(FrameDescriptor::Clock::time_point captured);
+
 	/**
 	* Sets the title of the current image stream.
 	* A title should represent the identity of a source stream as a string.
@@ -134,6 +192,34 @@ class ImageStream : public QObject {
 	*/
     void setTitle(std::string title);
 
+    /**
+     * Enables the decoded-frame cache if Config::FrameCacheMB is set.
+     * Only streams with random access (files) should enable it.
+     */
+    void enableFrameCache();
+
+    /**
+     * Drops all cached frames. Must be called when the stream's media changes.
+     */
+    void invalidateFrameCache();
+
+    /**
+     * Called after the current frame was served from the cache instead of the decoder.
+     * The current frame number is already updated; the implementation has to resynchronise its decoder before the next decode.
+     */
+    virtual void frameServedFromCache(size_t frame_number);
+
+    /**
+     * @return a frame backed by a recycled buffer of the stream's frame pool. Decoders should write into it in place.
+     */
+    std::shared_ptr<cv::Mat> acquireFrame(cv::Size size, int type);
+
+    /**
+     * Streams decoding single channel frames natively hand them in here (after set_current_frame),
+     * so the tracker gets them without a conversion round trip.
+     */
+    void setCurrentGrayFrame(std::shared_ptr<cv::Mat> gray);
+
 	/**
 	* The stride of the image stream. Think of it as "use only every n'th frame".
 	*/
@@ -149,6 +235,27 @@ class ImageStream : public QObject {
      * empties m_current_frame & sets m_current_frame_number to this->numFrames();
      */
     void clearImage();
+    /**
+     * serves frame_number from the cache, if it is there
+     */
+    bool serveFromCache(size_t frame_number);
+    /**
+     * puts the current frame into the cache
+     */
+    void cacheCurrentFrame();
+    /**
+     * returns the grayscale version of frame, converting it at most once
+     */
+    std::shared_ptr<cv::Mat> grayFrame(const std::shared_ptr<cv::Mat> &frame);
+
+    std::unique_ptr<FrameCache> m_frame_cache;
+    std::shared_ptr<FramePool> m_frame_pool;
+    cv::Rect m_crop_region;
+    bool m_tracking_grayscale = false;
+    std::weak_ptr<cv::Mat> m_gray_source;
+    std::shared_ptr<cv::Mat> m_gray_frame;
+    FrameDescriptor m_current_descriptor;
+    size_t m_sequence = 0;
     /**
      * - called by ImageStreamImpl::setFrameNumber
      *    if frame_number < numFrames() && frame_number != this->currentFrameNumber();
@@ -177,8 +284,49 @@ std::shared_ptr<ImageStream> make_ImageStream3Pictures(Config *cfg,
 std::shared_ptr<ImageStream> make_ImageStream3Video(Config *cfg, const std::vector<boost::filesystem::path>
                                                     &filename);
 
+/**
+ * Plays the given videos as one timeline with a global frame index
+ */
+std::shared_ptr<ImageStream> make_ImageStream3Timeline(Config *cfg, const std::vector<boost::filesystem::path> &files);
+
+/**
+ * Plays the given sources side by side, each decoded by its own thread and aligned by frame index or timestamp
+ */
+std::shared_ptr<ImageStream> make_ImageStream3Composite(Config *cfg, const std::vector<boost::filesystem::path> &files);
+
+/**
+ * Opens a memory mapped raw frame container (*.btraw), see RawFrameFile.h
+ */
+std::shared_ptr<ImageStream> make_ImageStream3Raw(Config *cfg, const boost::filesystem::path &file);
+
+/**
+ * Serves the procedurally rendered frames of a synthetic scene
+ */
+std::shared_ptr<ImageStream> make_ImageStream3Synthetic(Config *cfg, const SyntheticConfiguration &conf);
+
+/**
+ * Watches a directory and serves the images written into it while the stream is open
+ */
+std::shared_ptr<ImageStream> make_ImageStream3Directory(Config *cfg, const boost::filesystem::path &directory);
+
+/**
+ * Reads raw frames of the size and pixel format given in the config (PipeWidth, PipeHeight, PipeFormat) from a pipe, "-" is stdin
+ */
+std::shared_ptr<ImageStream> make_ImageStream3Pipe(Config *cfg, const boost::filesystem::path &pipe);
+
+/**
+ * Attaches to a frame ring in shared memory filled by another process, see SharedFrameRing.h
+ */
+std::shared_ptr<ImageStream> make_ImageStream3SharedMemory(Config *cfg, const std::string &name);
+
 std::shared_ptr<ImageStream> make_ImageStream3Camera(Config *cfg, CameraConfiguration conf);
 
+/**
+ * Opens files given as video: a raw frame file, several sources side by side (CompositeSources),
+ * one timeline (BatchTimeline) or a batch of videos played one after the other
+ */
+std::shared_ptr<ImageStream> make_ImageStream3Files(Config *cfg, const std::vector<boost::filesystem::path> &files);
+
 }
 }
 
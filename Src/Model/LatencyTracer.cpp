@@ -0,0 +1,91 @@
+#include "LatencyTracer.h"
+
+#include <algorithm>
+
+namespace BioTracker {
+	namespace Core {
+
+		namespace {
+			const char *StageNames[FrameDescriptor::StageCount] = {
+				"captured", "decode_ms", "handoff_ms", "tracking_ms", "render_ms", "export_ms"
+			};
+		}
+
+		LatencyTracer::~LatencyTracer() {
+			close();
+		}
+
+		bool LatencyTracer::open(const std::string &file, const std::string &separator) {
+			close();
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_file.open(file, std::ios::out | std::ios::trunc);
+			if (!m_file) {
+				return false;
+			}
+			m_separator = separator;
+			m_file << "sequence" << m_separator << "source_frame";
+			for (int stage = FrameDescriptor::Decoded; stage < FrameDescriptor::StageCount; stage++) {
+				m_file << m_separator << StageNames[stage];
+			}
+			m_file << "\n";
+			m_enabled = true;
+			return true;
+		}
+
+		void LatencyTracer::close() {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (!m_enabled) {
+				return;
+			}
+			for (const FrameDescriptor &descriptor : m_frames) {
+				write(descriptor);
+			}
+			m_frames.clear();
+			m_file.close();
+			m_enabled = false;
+		}
+
+		void LatencyTracer::begin(const FrameDescriptor &descriptor) {
+			if (!m_enabled) {
+				return;
+			}
+			std::lock_guard<std::mutex> lock(m_mutex);
+			// the player emits its parameters again without a new frame, e.g. on pause
+			if (!m_frames.empty() && m_frames.back().sequence == descriptor.sequence) {
+				return;
+			}
+			m_frames.push_back(descriptor);
+			while (m_frames.size() > InFlight) {
+				write(m_frames.front());
+				m_frames.pop_front();
+			}
+		}
+
+		void LatencyTracer::stamp(size_t sourceFrame, FrameDescriptor::Stage stage) {
+			if (!m_enabled) {
+				return;
+			}
+			const FrameDescriptor::Clock::time_point now = FrameDescriptor::Clock::now();
+			std::lock_guard<std::mutex> lock(m_mutex);
+			auto it = std::find_if(m_frames.rbegin(), m_frames.rend(), [sourceFrame](const FrameDescriptor &descriptor) {
+				return descriptor.sourceFrame == sourceFrame;
+			});
+			if (it != m_frames.rend() && !it->reached(stage)) {
+				it->stamps[stage] = now;
+			}
+		}
+
+		void LatencyTracer::write(const FrameDescriptor &descriptor) {
+			m_file << descriptor.sequence << m_separator << descriptor.sourceFrame;
+			for (int stage = FrameDescriptor::Decoded; stage < FrameDescriptor::StageCount; stage++) {
+				m_file << m_separator;
+				if (descriptor.reached(static_cast<FrameDescriptor::Stage>(stage))) {
+					m_file << descriptor.latencyMs(static_cast<FrameDescriptor::Stage>(stage));
+				}
+			}
+			m_file << "\n";
+		}
+
+	}
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Model/FrameDescriptor.h"
+
+#include <atomic>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+
+namespace BioTracker {
+namespace Core {
+
+/**
+ * The LatencyTracer collects the FrameDescriptors of the frames in flight and writes one CSV row per frame,
+ * holding the latency of every stage relative to the capture time of the frame.
+ * Stages only knowing the frame number (tracker, exporter) stamp the descriptor by its source frame number.
+ * A frame is written once it is displaced by newer frames, so late stages of the last frames are still recorded.
+ * Tracing is disabled until open() is called and costs a branch per stage then.
+ */
+class LatencyTracer {
+public:
+	static LatencyTracer& instance() {
+		static LatencyTracer _instance;
+		return _instance;
+	}
+
+	~LatencyTracer();
+
+	/**
+	 * Starts writing the trace to file (an existing file is overwritten).
+	 * @return false if the file could not be opened
+	 */
+	bool open(const std::string &file, const std::string &separator = ";");
+
+	/**
+	 * Writes all frames in flight and stops tracing.
+	 */
+	void close();
+
+	bool enabled() const {
+		return m_enabled;
+	}
+
+	/**
+	 * Registers a frame delivered by the stream. A frame that is already in flight is not registered again.
+	 */
+	void begin(const FrameDescriptor &descriptor);
+
+	/**
+	 * Records that the most recent frame with the given source frame number reached stage now.
+	 */
+	void stamp(size_t sourceFrame, FrameDescriptor::Stage stage);
+
+private:
+	LatencyTracer() = default;
+	LatencyTracer(const LatencyTracer&) = delete;
+	LatencyTracer& operator=(const LatencyTracer&) = delete;
+
+	void write(const FrameDescriptor &descriptor);
+
+	// number of frames kept in flight before the oldest is written
+	static const size_t InFlight = 16;
+
+	std::atomic<bool> m_enabled{ false };
+	std::string m_separator;
+	std::ofstream m_file;
+	std::deque<FrameDescriptor> m_frames;
+	std::mutex m_mutex;
+};
+
+}
+}
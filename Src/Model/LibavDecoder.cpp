@@ -0,0 +1,179 @@
+#include "LibavDecoder.h"
+
+#if HAS_LIBAV
+
+#include "util/Exceptions.h"
+
+#include <algorithm>
+#include <cmath>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libswscale/swscale.h>
+}
+
+namespace BioTracker {
+	namespace Core {
+
+		namespace {
+			const AVRational MICROSECONDS = { 1, 1000000 };
+		}
+
+		LibavDecoder::LibavDecoder(const boost::filesystem::path &file, int threads, Threading threading) {
+			if (avformat_open_input(&m_format, file.string().c_str(), nullptr, nullptr) < 0) {
+				throw video_open_error("Could not open video " + file.string());
+			}
+			// from here on the destructor is not run on errors
+			try {
+				if (avformat_find_stream_info(m_format, nullptr) < 0) {
+					throw video_open_error("Could not read stream info of " + file.string());
+				}
+				m_stream = av_find_best_stream(m_format, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+				if (m_stream < 0) {
+					throw video_open_error("No video stream in " + file.string());
+				}
+				AVStream *stream = m_format->streams[m_stream];
+				const AVCodec *codec = avcodec_find_decoder(stream->codecpar->codec_id);
+				if (!codec) {
+					throw video_open_error("No decoder for " + file.string());
+				}
+
+				m_codec = avcodec_alloc_context3(codec);
+				avcodec_parameters_to_context(m_codec, stream->codecpar);
+				m_codec->thread_count = std::max(threads, 0);
+				switch (threading) {
+				case Threading::Frame:
+					m_codec->thread_type = FF_THREAD_FRAME;
+					break;
+				case Threading::Slice:
+					m_codec->thread_type = FF_THREAD_SLICE;
+					break;
+				default:
+					m_codec->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+					break;
+				}
+				if (avcodec_open2(m_codec, codec, nullptr) < 0) {
+					throw video_open_error("Could not open decoder for " + file.string());
+				}
+
+				m_timeBaseNum = stream->time_base.num;
+				m_timeBaseDen = stream->time_base.den;
+				m_start = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+				AVRational rate = stream->avg_frame_rate.num > 0 ? stream->avg_frame_rate : stream->r_frame_rate;
+				m_fps = rate.num > 0 && rate.den > 0 ? av_q2d(rate) : 25;
+				if (stream->nb_frames > 0) {
+					m_numFrames = static_cast<size_t>(stream->nb_frames);
+				}
+				else if (m_format->duration > 0) {
+					m_numFrames = static_cast<size_t>(m_format->duration * m_fps / AV_TIME_BASE);
+				}
+
+				m_frame = av_frame_alloc();
+				m_packet = av_packet_alloc();
+			}
+			catch (...) {
+				avcodec_free_context(&m_codec);
+				avformat_close_input(&m_format);
+				throw;
+			}
+		}
+
+		LibavDecoder::~LibavDecoder() {
+			sws_freeContext(m_sws);
+			av_packet_free(&m_packet);
+			av_frame_free(&m_frame);
+			avcodec_free_context(&m_codec);
+			avformat_close_input(&m_format);
+		}
+
+		size_t LibavDecoder::numFrames() const {
+			return m_numFrames;
+		}
+
+		double LibavDecoder::fps() const {
+			return m_fps;
+		}
+
+		cv::Size LibavDecoder::size() const {
+			return cv::Size(m_codec->width, m_codec->height);
+		}
+
+		bool LibavDecoder::read(cv::Mat &dst) {
+			if (m_pending) {
+				m_pending = false;
+			}
+			else if (!decode()) {
+				return false;
+			}
+			convert(dst);
+			return true;
+		}
+
+		int64_t LibavDecoder::timestamp() const {
+			return av_rescale_q(m_pts - m_start, AVRational{ m_timeBaseNum, m_timeBaseDen }, MICROSECONDS);
+		}
+
+		size_t LibavDecoder::frameNumber() const {
+			return static_cast<size_t>(std::max<int64_t>(std::llround(timestamp() * m_fps / 1e6), 0));
+		}
+
+		bool LibavDecoder::seek(size_t frame_number) {
+			const AVRational timeBase = { m_timeBaseNum, m_timeBaseDen };
+			const int64_t target = m_start + av_rescale_q(std::llround(frame_number * 1e6 / m_fps), MICROSECONDS, timeBase);
+			const int64_t halfFrame = av_rescale_q(std::llround(0.5e6 / m_fps), MICROSECONDS, timeBase);
+
+			if (av_seek_frame(m_format, m_stream, target, AVSEEK_FLAG_BACKWARD) < 0) {
+				return false;
+			}
+			avcodec_flush_buffers(m_codec);
+			m_drained = false;
+			m_pending = false;
+
+			// decode forward from the keyframe, the target frame is kept for the next read
+			while (decode()) {
+				if (m_pts >= target - halfFrame) {
+					m_pending = true;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		bool LibavDecoder::decode() {
+			for (;;) {
+				const int received = avcodec_receive_frame(m_codec, m_frame);
+				if (received == 0) {
+					m_pts = m_frame->best_effort_timestamp != AV_NOPTS_VALUE ? m_frame->best_effort_timestamp : m_frame->pts;
+					return true;
+				}
+				if (received != AVERROR(EAGAIN) || m_drained) {
+					return false;
+				}
+
+				if (av_read_frame(m_format, m_packet) < 0) {
+					// end of file: drain the frames still buffered by (frame) threads
+					avcodec_send_packet(m_codec, nullptr);
+					m_drained = true;
+					continue;
+				}
+				if (m_packet->stream_index == m_stream) {
+					avcodec_send_packet(m_codec, m_packet);
+				}
+				av_packet_unref(m_packet);
+			}
+		}
+
+		void LibavDecoder::convert(cv::Mat &dst) {
+			const AVPixelFormat target = dst.channels() == 1 ? AV_PIX_FMT_GRAY8 : AV_PIX_FMT_BGR24;
+			m_sws = sws_getCachedContext(m_sws, m_frame->width, m_frame->height, static_cast<AVPixelFormat>(m_frame->format),
+				dst.cols, dst.rows, target, SWS_BILINEAR, nullptr, nullptr, nullptr);
+			uint8_t *data[4] = { dst.data, nullptr, nullptr, nullptr };
+			int linesize[4] = { static_cast<int>(dst.step[0]), 0, 0, 0 };
+			sws_scale(m_sws, m_frame->data, m_frame->linesize, 0, m_frame->height, data, linesize);
+		}
+
+	}
+}
+
+#endif
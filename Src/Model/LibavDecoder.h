@@ -0,0 +1,96 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <boost/filesystem.hpp>
+
+#include <cstdint>
+
+struct AVFormatContext;
+struct AVCodecContext;
+struct AVFrame;
+struct AVPacket;
+struct SwsContext;
+
+namespace BioTracker {
+namespace Core {
+
+/**
+ * The LibavDecoder decodes the video stream of a file directly with libavformat/libavcodec.
+ * Unlike cv::VideoCapture it exposes the decoder threading and converts the decoded frames with swscale
+ * straight into caller provided buffers, in BGR or gray. Frame numbers are derived from the presentation
+ * timestamps, so seeking is frame-accurate for constant frame rate videos.
+ * Only available if BioTracker is built with libav support (HAS_LIBAV).
+ */
+class LibavDecoder {
+public:
+	enum class Threading {
+		FrameAndSlice = 0,	///< let the codec pick whatever it supports
+		Frame = 1,			///< decode several frames in parallel (more throughput, more latency)
+		Slice = 2			///< decode the slices of one frame in parallel (no additional latency)
+	};
+
+	/**
+	 * @param threads number of decoder threads, 0 lets libavcodec choose
+	 * @throw video_open_error when the file has no decodable video stream
+	 */
+	LibavDecoder(const boost::filesystem::path &file, int threads, Threading threading);
+	~LibavDecoder();
+
+	LibavDecoder(const LibavDecoder&) = delete;
+	LibavDecoder& operator=(const LibavDecoder&) = delete;
+
+	/**
+	 * @return the number of frames as stated by the container (an estimate from the duration if it states none)
+	 */
+	size_t numFrames() const;
+	double fps() const;
+	cv::Size size() const;
+
+	/**
+	 * Decodes the next frame and converts it into dst. dst has to be allocated with size() and CV_8UC3 (BGR) or CV_8UC1.
+	 * @return false at the end of the video or on a decoding error
+	 */
+	bool read(cv::Mat &dst);
+
+	/**
+	 * @return the presentation timestamp of the frame returned last by read() in microseconds since the start of the video
+	 */
+	int64_t timestamp() const;
+
+	/**
+	 * @return the number of the frame returned last by read(), derived from its timestamp
+	 */
+	size_t frameNumber() const;
+
+	/**
+	 * Positions the decoder so that the next read() returns frame_number.
+	 * Seeks to the preceding keyframe and decodes forward from there.
+	 */
+	bool seek(size_t frame_number);
+
+private:
+	/**
+	 * receives the next decoded frame into m_frame, feeding packets as needed
+	 */
+	bool decode();
+	void convert(cv::Mat &dst);
+
+	AVFormatContext *m_format = nullptr;
+	AVCodecContext *m_codec = nullptr;
+	AVFrame *m_frame = nullptr;
+	AVPacket *m_packet = nullptr;
+	SwsContext *m_sws = nullptr;
+	int m_stream = -1;
+	int m_timeBaseNum = 1;
+	int m_timeBaseDen = 1;
+	int64_t m_start = 0;
+	int64_t m_pts = 0;
+	double m_fps = 0;
+	size_t m_numFrames = 0;
+	bool m_drained = false;
+	// a frame decoded by seek(), returned by the next read()
+	bool m_pending = false;
+};
+
+}
+}
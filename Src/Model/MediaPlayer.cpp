@@ -1,5 +1,8 @@
 #include "MediaPlayer.h"
 #include "Utility/misc.h"
+#include "Model/LatencyTracer.h"
+
+#include <algorithm>
 
 
 //Settings related
@@ -37,6 +40,10 @@ MediaPlayer::MediaPlayer(QObject* parent) :
     // Load ImageStreams in StateMachine
     QObject::connect(this, &MediaPlayer::loadVideoStream, m_Player, &MediaPlayerStateMachine::receiveLoadVideoCommand);
     QObject::connect(this, &MediaPlayer::loadCameraDevice, m_Player, &MediaPlayerStateMachine::receiveLoadCameraDevice);
+    QObject::connect(this, &MediaPlayer::loadSynthetic, m_Player, &MediaPlayerStateMachine::receiveLoadSynthetic);
+    QObject::connect(this, &MediaPlayer::loadDirectory, m_Player, &MediaPlayerStateMachine::receiveLoadDirectory);
+    QObject::connect(this, &MediaPlayer::loadPipe, m_Player, &MediaPlayerStateMachine::receiveLoadPipe);
+    QObject::connect(this, &MediaPlayer::loadSharedMemory, m_Player, &MediaPlayerStateMachine::receiveLoadSharedMemory);
     QObject::connect(this, &MediaPlayer::loadPictures, m_Player, &MediaPlayerStateMachine::receiveLoadPictures);
 
     // Controll the Player
@@ -46,6 +53,9 @@ MediaPlayer::MediaPlayer(QObject* parent) :
     QObject::connect(this, &MediaPlayer::prevFrameCommand, m_Player, &MediaPlayerStateMachine::receivePrevFrameCommand);
     QObject::connect(this, &MediaPlayer::stopCommand, m_Player, &MediaPlayerStateMachine::receiveStopCommand);
     QObject::connect(this, &MediaPlayer::goToFrame, m_Player, &MediaPlayerStateMachine::receiveGoToFrame);
+    QObject::connect(this, &MediaPlayer::cropRegion, m_Player, &MediaPlayerStateMachine::receiveCropRegion);
+    QObject::connect(this, &MediaPlayer::trackingGrayscale, m_Player, &MediaPlayerStateMachine::receiveTrackingGrayscale);
+    QObject::connect(this, &MediaPlayer::previewScale, m_Player, &MediaPlayerStateMachine::receivePreviewScale);
 
     QObject::connect(this, &MediaPlayer::pauseCommand, this, &MediaPlayer::receiveTrackingPaused);
     QObject::connect(this, &MediaPlayer::stopCommand, this, &MediaPlayer::receiveTrackingPaused);
@@ -55,6 +65,8 @@ MediaPlayer::MediaPlayer(QObject* parent) :
     // Handle PlayerStateMachine results
 	QObject::connect(m_Player, &MediaPlayerStateMachine::emitPlayerParameters, this, &MediaPlayer::receivePlayerParameters);
 	QObject::connect(m_Player, &MediaPlayerStateMachine::emitPlayerParameters, this, &MediaPlayer::fwdPlayerParameters);
+	// Connected last: queued slots run in connection order, so all consumers are done with the parameters
+	QObject::connect(m_Player, &MediaPlayerStateMachine::emitPlayerParameters, this, &MediaPlayer::receivePlayerParametersConsumed);
 
     // Handle next state operation
     QObject::connect(m_Player, &MediaPlayerStateMachine::emitPlayerOperationDone, this, &MediaPlayer::receivePlayerOperationDone);
@@ -86,6 +98,23 @@ void MediaPlayer::setTrackingActive() {
 
 void MediaPlayer::setTrackingDeactive() {
     m_TrackingIsActive = false;
+
+    // Frames still waiting for the tracker are not held back any longer
+    if (!m_PendingRenders.empty()) {
+        renderFrame(m_PendingRenders.back());
+        m_PendingRenders.clear();
+    }
+    releasePlayer();
+}
+
+void MediaPlayer::setTrackingPipeline(bool emitsTrackingDone) {
+    m_TrackingPipelineFrames = emitsTrackingDone ? static_cast<size_t>(std::max(_cfg->TrackingPipelineFrames, 0)) : 0;
+
+    if (m_TrackingPipelineFrames == 0 && !m_PendingRenders.empty()) {
+        renderFrame(m_PendingRenders.back());
+        m_PendingRenders.clear();
+    }
+    releasePlayer();
 }
 
 bool MediaPlayer::getPlayState() {
@@ -240,10 +269,27 @@ void MediaPlayer::receivePlayerParameters(playerParameters* param) {
 
     if (isValidFrame)
     {
-        Q_EMIT renderCurrentImage(m_CurrentFrame, m_NameOfCvMat);
+        BioTracker::Core::LatencyTracer &tracer = BioTracker::Core::LatencyTracer::instance();
+        tracer.begin(param->m_FrameDescriptor);
+
+        PendingRender render{ static_cast<uint>(m_CurrentFrameNumber), param->m_PreviewFrame ? param->m_PreviewFrame : m_CurrentFrame,
+            QSize(m_CurrentFrame->cols, m_CurrentFrame->rows), param->m_FrameDescriptor.sourceFrame };
+        if (m_TrackingIsActive && m_TrackingPipelineFrames > 0) {
+            // Rendered when the tracker is done with the frame, so the image matches the tracking overlay
+            m_PendingRenders.push_back(render);
+            // The tracker fell behind by more than the window: the oldest frames are shown without waiting for it
+            while (m_PendingRenders.size() > m_TrackingPipelineFrames) {
+                renderFrame(m_PendingRenders.front());
+                m_PendingRenders.pop_front();
+            }
+        }
+        else {
+            renderFrame(render);
+        }
 
         if (m_TrackingIsActive) {
-            Q_EMIT trackCurrentImage(m_CurrentFrame, static_cast<uint>(m_CurrentFrameNumber));
+            tracer.stamp(param->m_FrameDescriptor.sourceFrame, BioTracker::Core::FrameDescriptor::TrackerHandoff);
+            Q_EMIT trackCurrentImage(param->m_TrackingFrame ? param->m_TrackingFrame : m_CurrentFrame, static_cast<uint>(m_CurrentFrameNumber));
         }
         else {
             Q_EMIT signalVisualizeCurrentModel(static_cast<uint>(m_CurrentFrameNumber));
@@ -294,18 +340,66 @@ void MediaPlayer::rcvPauseState(bool state) {
 }
 
 void MediaPlayer::receivePlayerOperationDone() {
+    // The tracking pipeline is full, the next operation runs once the tracker caught up
+    if (m_ReleasePending) {
+        m_RunPending = true;
+        return;
+    }
+    emit runPlayerOperation();
+}
+
+void MediaPlayer::receivePlayerParametersConsumed(playerParameters* param) {
+    if (trackingPipelineFull()) {
+        m_ReleasePending = true;
+    }
+    else {
+        m_Player->releasePlayerParameters();
+    }
+
+    // Measured per received frame, the player does not report each operation while it plays in its direct loop
 	end = std::chrono::system_clock::now();
-	long s = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-    if (!_paused) {
-        m_currentFPS = floor(1.0 / (double(s) / 1000.0));
+	long us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    if (!_paused && us > 0) {
+        m_currentFPS = floor(1.0 / (double(us) / 1000000.0));
     }
     else {
         m_currentFPS = 0;
     }
+    start = end;
+}
 
-    emit runPlayerOperation();
+void MediaPlayer::receiveFrameTracked(uint frameNumber) {
+    auto render = std::find_if(m_PendingRenders.begin(), m_PendingRenders.end(), [frameNumber](const PendingRender &r) {
+        return r.frameNumber == frameNumber;
+    });
+    if (render != m_PendingRenders.end()) {
+        renderFrame(*render);
+        // Earlier frames were given up by the tracker
+        m_PendingRenders.erase(m_PendingRenders.begin(), render + 1);
+    }
+    releasePlayer();
+}
+
+void MediaPlayer::renderFrame(const PendingRender &render) {
+    Q_EMIT renderCurrentImage(render.image, m_NameOfCvMat, render.sourceSize);
+    BioTracker::Core::LatencyTracer::instance().stamp(render.sourceFrame, BioTracker::Core::FrameDescriptor::Rendered);
+}
 
-    start = std::chrono::system_clock::now();
+bool MediaPlayer::trackingPipelineFull() const {
+    return m_TrackingIsActive && m_TrackingPipelineFrames > 0
+        && m_PendingRenders.size() >= m_TrackingPipelineFrames;
+}
+
+void MediaPlayer::releasePlayer() {
+    if (!m_ReleasePending || trackingPipelineFull()) {
+        return;
+    }
+    m_ReleasePending = false;
+    m_Player->releasePlayerParameters();
+    if (m_RunPending) {
+        m_RunPending = false;
+        emit runPlayerOperation();
+    }
 }
 
 void MediaPlayer::receiveChangeDisplayImage(QString str) {
@@ -16,6 +16,7 @@
 
 #include <ctime>
 #include <chrono>
+#include <deque>
 #include "util/types.h"
 #include "util/VideoCoder.h"
 #include "util/Config.h"
@@ -46,12 +47,40 @@ class MediaPlayer : public IModel {
     * Emit the camera device number. This signal will be received by the MediaPlayerStateMachine which runns in a separate Thread.
     */
     void loadCameraDevice(CameraConfiguration conf);
+    /**
+    * Emit the parameters of a synthetic scene. This signal will be received by the MediaPlayerStateMachine which runns in a separate Thread.
+    */
+    void loadSynthetic(BioTracker::Core::SyntheticConfiguration conf);
+    /**
+    * Emit the path of a directory to watch for new images. This signal will be received by the MediaPlayerStateMachine which runns in a separate Thread.
+    */
+    void loadDirectory(boost::filesystem::path directory);
+    /**
+    * Emit the path of a pipe (or "-" for stdin) to read raw frames from. This signal will be received by the MediaPlayerStateMachine which runns in a separate Thread.
+    */
+    void loadPipe(boost::filesystem::path pipe);
+    /**
+    * Emit the name of a shared memory frame ring to attach to. This signal will be received by the MediaPlayerStateMachine which runns in a separate Thread.
+    */
+    void loadSharedMemory(QString name);
 
     /**
     * Emit a frame number. This signal will be received by the MediaPlayerStateMachine which runns in a separate Thread.
     */
     void goToFrame(int frame);
     /**
+    * Emit the region of the frame handed to the tracker. This signal will be received by the MediaPlayerStateMachine which runns in a separate Thread.
+    */
+    void cropRegion(QRect region);
+    /**
+    * Emit whether the tracker wants single channel frames. This signal will be received by the MediaPlayerStateMachine which runns in a separate Thread.
+    */
+    void trackingGrayscale(bool grayscale);
+    /**
+    * Emit the scale of the preview frames for the display. This signal will be received by the MediaPlayerStateMachine which runns in a separate Thread.
+    */
+    void previewScale(double scale);
+    /**
     * Emit the next frame command. This signal will be received by the MediaPlayerStateMachine which runns in a separate Thread.
     */
     void nextFrameCommand();
@@ -79,8 +108,9 @@ class MediaPlayer : public IModel {
 
     /**
      * This SIGNAL will send a cv::Mat and a name to the MediaPlayer controller class. This controller will give the data to the TextureObject component.
+     * The cv::Mat may be a downscaled preview, sourceSize is the size of the frame it was built from.
      */
-    void renderCurrentImage(std::shared_ptr<cv::Mat> mat, QString name);
+    void renderCurrentImage(std::shared_ptr<cv::Mat> mat, QString name, QSize sourceSize);
     /**
      * This SIGNAL is only emmited if Tracking Is Active. The PluginLoader component will receive the cv::Mat and the current frame number.
      */
@@ -102,6 +132,11 @@ class MediaPlayer : public IModel {
   public:
     void setTrackingActive();
     void setTrackingDeactive();
+    /**
+    * Holds frames back until the tracker is done with them, up to TrackingPipelineFrames frames.
+    * Only used with plugins that report each frame with emitTrackingDone, others would never release the frames.
+    */
+    void setTrackingPipeline(bool emitsTrackingDone);
     void setTargetFPS(double fps);
 
     bool getPlayState();
@@ -138,6 +173,17 @@ class MediaPlayer : public IModel {
      */
     void receivePlayerOperationDone();
 
+    /**
+     * Triggered after all receivers of the playerParameters handled them. Releases the parameters to the MediaPlayerStateMachine.
+     */
+    void receivePlayerParametersConsumed(playerParameters* param);
+
+    /**
+     * The tracker is done with frameNumber (in hand-off order). Renders that frame if it was held back for the tracker
+     * and lets the MediaPlayerStateMachine continue if the tracking pipeline has room again.
+     */
+    void receiveFrameTracked(uint frameNumber);
+
     /**
     * 
     */
@@ -159,6 +205,26 @@ class MediaPlayer : public IModel {
 	  * helper function which opens a video. If video size has changed, a new video is opened. 
 	  */
 	int reopenVideoWriter();
+
+	/**
+	 * A frame waiting for the tracker before it is rendered.
+	 */
+	struct PendingRender {
+		uint frameNumber;
+		std::shared_ptr<cv::Mat> image;
+		QSize sourceSize;
+		size_t sourceFrame;
+	};
+
+	void renderFrame(const PendingRender &render);
+	/**
+	 * True if the window of frames handed to the tracker and not rendered yet is full.
+	 */
+	bool trackingPipelineFull() const;
+	/**
+	 * Releases the parameters (and a deferred operation) to the MediaPlayerStateMachine once the pipeline has room.
+	 */
+	void releasePlayer();
 	int _imagew;
 	int _imageh;
     Config *_cfg;
@@ -203,6 +269,12 @@ class MediaPlayer : public IModel {
     QString m_NameOfCvMat = "Original";
 
 
+    // Window of frames held back for the tracker, 0 renders every frame right away
+    size_t m_TrackingPipelineFrames = 0;
+    std::deque<PendingRender> m_PendingRenders;
+    bool m_ReleasePending = false;
+    bool m_RunPending = false;
+
     std::chrono::system_clock::time_point start;
     std::chrono::system_clock::time_point end;
 };
@@ -11,9 +11,14 @@
 
 #include "util/types.h"
 
+#include <QDebug>
+
+#include <algorithm>
+
 MediaPlayerStateMachine::MediaPlayerStateMachine(QObject* parent) :
 	IModel(parent),
-	m_ImageStream(BioTracker::Core::make_ImageStream3NoMedia()) {
+	m_ImageStream(BioTracker::Core::make_ImageStream3NoMedia()),
+	m_PreviewPool(BioTracker::Core::FramePool::create(4)) {
 
 	m_PlayerParameters = new playerParameters();
 
@@ -38,10 +43,25 @@ MediaPlayerStateMachine::MediaPlayerStateMachine(QObject* parent) :
 
 void MediaPlayerStateMachine::receiveRunPlayerOperation() {
 
+	// Operations queued before the play loop took over are handled by the loop
+	if (m_InPlayLoop) {
+		return;
+	}
+
+	IPlayerState *play = m_States.value(IPlayerState::PLAYER_STATES::STATE_PLAY);
+	if (_cfg->PlayerDirectLoop && m_NextPlayerState == play) {
+		runPlayLoop();
+		return;
+	}
+
 	if (m_NextPlayerState != m_States.value(IPlayerState::PLAYER_STATES::STATE_WAIT)) {
 
+		const auto begin = std::chrono::steady_clock::now();
 		m_CurrentPlayerState = m_NextPlayerState;
 		m_CurrentPlayerState->operate();
+		if (m_CurrentPlayerState == play) {
+			recordTiming(begin, std::chrono::steady_clock::now());
+		}
 
 		updatePlayerParameter();
 		emitSignals();
@@ -49,22 +69,104 @@ void MediaPlayerStateMachine::receiveRunPlayerOperation() {
 
 }
 
-void MediaPlayerStateMachine::receiveLoadVideoCommand(std::vector<boost::filesystem::path> files) {
+void MediaPlayerStateMachine::runPlayLoop() {
+	m_InPlayLoop = true;
+	m_FramePending = false;
+	schedulePlayLoop();
+}
 
-	m_stream = BioTracker::Core::make_ImageStream3Video(_cfg, files);
+void MediaPlayerStateMachine::schedulePlayLoop() {
+	QMetaObject::invokeMethod(this, "playLoopStep", Qt::QueuedConnection);
+}
 
-	m_PlayerParameters->m_TotalNumbFrames = m_stream->numFrames();
-	
-	for (auto x: m_States) {
-		x->changeImageStream(m_stream);
+void MediaPlayerStateMachine::playLoopStep() {
+	IPlayerState *play = m_States.value(IPlayerState::PLAYER_STATES::STATE_PLAY);
+	if (!m_InPlayLoop) {
+		return;
+	}
+	// Stop, pause, quit or a new stream end the loop, a slow consumer does not
+	if (m_NextPlayerState != play || QThread::currentThread()->isInterruptionRequested()) {
+		m_InPlayLoop = false;
+		m_FramePending = false;
+		// Hand over to the regular state handling for the state that ended the loop
+		Q_EMIT emitPlayerOperationDone();
+		return;
 	}
 
-	setNextState(IPlayerState::STATE_INITIAL_STREAM);
+	if (!m_FramePending) {
+		// The next frame is decoded while the consumer still works on the previous one
+		m_FrameBegin = std::chrono::steady_clock::now();
+		m_CurrentPlayerState = play;
+		m_CurrentPlayerState->operate();
+		m_FrameOperated = std::chrono::steady_clock::now();
+		m_FramePending = true;
+	}
 
+	{
+		// The consumer may still read the parameters, they are not touched before it released them.
+		// releasePlayerParameters schedules the next step then.
+		std::lock_guard<std::mutex> lock(m_ConsumerMutex);
+		if (m_ParametersInUse) {
+			m_WaitingForConsumer = true;
+			return;
+		}
+	}
+
+	m_FramePending = false;
+	recordTiming(m_FrameBegin, m_FrameOperated);
+	updatePlayerParameter();
+	emitSignals();
+	schedulePlayLoop();
 }
 
-void MediaPlayerStateMachine::receiveLoadPictures(std::vector<boost::filesystem::path> files) {
-	m_stream = BioTracker::Core::make_ImageStream3Pictures(_cfg, files);
+void MediaPlayerStateMachine::releasePlayerParameters() {
+	std::lock_guard<std::mutex> lock(m_ConsumerMutex);
+	if (m_ParametersInUse) {
+		const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - m_ParametersEmitted).count();
+		m_ConsumerUs = m_ConsumerUs ? 0.95 * m_ConsumerUs + 0.05 * us : us;
+		m_ParametersInUse = false;
+	}
+	if (m_WaitingForConsumer) {
+		m_WaitingForConsumer = false;
+		schedulePlayLoop();
+	}
+}
+
+void MediaPlayerStateMachine::recordTiming(std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point operated) {
+	const double operateUs = std::chrono::duration<double, std::micro>(operated - begin).count();
+	m_OperateUs = m_TimedFrames ? 0.95 * m_OperateUs + 0.05 * operateUs : operateUs;
+	// A frame is the time between two frames starting; the first frame after a pause has no predecessor
+	if (m_TimedFrames && begin - m_LastCycle < std::chrono::seconds(1)) {
+		const double cycleUs = std::chrono::duration<double, std::micro>(begin - m_LastCycle).count();
+		m_CycleUs = m_CycleUs ? 0.95 * m_CycleUs + 0.05 * cycleUs : cycleUs;
+	}
+	m_LastCycle = begin;
+	m_TimedFrames++;
+
+	double consumerUs;
+	{
+		std::lock_guard<std::mutex> lock(m_ConsumerMutex);
+		consumerUs = m_ConsumerUs;
+	}
+	// Decode and consumer overlap in both modes, whatever a frame takes beyond the slower of both is overhead
+	// (queued signal round trips, waiting for wakeups, the target fps delay)
+	const double overheadUs = std::max(0.0, m_CycleUs - std::max(m_OperateUs, consumerUs));
+	m_PlayerParameters->m_PlayerCycleUs = m_CycleUs;
+	m_PlayerParameters->m_PlayerOperateUs = m_OperateUs;
+	m_PlayerParameters->m_PlayerConsumerUs = consumerUs;
+	m_PlayerParameters->m_PlayerOverheadUs = overheadUs;
+
+	if (m_TimedFrames % 1000 == 0) {
+		qDebug() << "Player" << (m_InPlayLoop ? "(direct loop):" : "(signals):")
+			<< "frame" << m_CycleUs << "us, operate" << m_OperateUs << "us, consumer" << consumerUs
+			<< "us, overhead" << overheadUs << "us";
+	}
+}
+
+void MediaPlayerStateMachine::useStream(std::shared_ptr<BioTracker::Core::ImageStream> stream) {
+	m_stream = stream;
+	m_stream->setCropRegion(m_CropRegion);
+	m_stream->setTrackingGrayscale(m_TrackingGrayscale);
 
 	m_PlayerParameters->m_TotalNumbFrames = m_stream->numFrames();
 
@@ -73,24 +175,39 @@ void MediaPlayerStateMachine::receiveLoadPictures(std::vector<boost::filesystem:
 	}
 
 	setNextState(IPlayerState::STATE_INITIAL_STREAM);
+}
 
+void MediaPlayerStateMachine::receiveLoadVideoCommand(std::vector<boost::filesystem::path> files) {
+	useStream(BioTracker::Core::make_ImageStream3Files(_cfg, files));
 }
 
-void MediaPlayerStateMachine::receiveLoadCameraDevice(CameraConfiguration conf) {
-	m_stream.reset();
-	for (auto x: m_States) {
-		x->changeImageStream(m_stream);
-	}
+void MediaPlayerStateMachine::receiveLoadPictures(std::vector<boost::filesystem::path> files) {
+	useStream(BioTracker::Core::make_ImageStream3Pictures(_cfg, files));
+}
 
-	m_stream = BioTracker::Core::make_ImageStream3Camera(_cfg, conf);
+void MediaPlayerStateMachine::receiveLoadSynthetic(BioTracker::Core::SyntheticConfiguration conf) {
+	useStream(BioTracker::Core::make_ImageStream3Synthetic(_cfg, conf));
+}
 
-	m_PlayerParameters->m_TotalNumbFrames = m_stream->numFrames();
+void MediaPlayerStateMachine::receiveLoadDirectory(boost::filesystem::path directory) {
+	useStream(BioTracker::Core::make_ImageStream3Directory(_cfg, directory));
+}
+
+void MediaPlayerStateMachine::receiveLoadPipe(boost::filesystem::path pipe) {
+	useStream(BioTracker::Core::make_ImageStream3Pipe(_cfg, pipe));
+}
+
+void MediaPlayerStateMachine::receiveLoadSharedMemory(QString name) {
+	useStream(BioTracker::Core::make_ImageStream3SharedMemory(_cfg, name.toStdString()));
+}
 
+void MediaPlayerStateMachine::receiveLoadCameraDevice(CameraConfiguration conf) {
+	m_stream.reset();
 	for (auto x: m_States) {
 		x->changeImageStream(m_stream);
 	}
 
-	setNextState(IPlayerState::STATE_INITIAL_STREAM);
+	useStream(BioTracker::Core::make_ImageStream3Camera(_cfg, conf));
 }
 
 void MediaPlayerStateMachine::receivePrevFrameCommand() {
@@ -113,6 +230,24 @@ void MediaPlayerStateMachine::receivePlayCommand() {
 	setNextState(IPlayerState::STATE_PLAY);
 }
 
+void MediaPlayerStateMachine::receiveCropRegion(QRect region) {
+	m_CropRegion = cv::Rect(region.x(), region.y(), region.width(), region.height());
+	if (m_stream) {
+		m_stream->setCropRegion(m_CropRegion);
+	}
+}
+
+void MediaPlayerStateMachine::receiveTrackingGrayscale(bool grayscale) {
+	m_TrackingGrayscale = grayscale;
+	if (m_stream) {
+		m_stream->setTrackingGrayscale(grayscale);
+	}
+}
+
+void MediaPlayerStateMachine::receivePreviewScale(double scale) {
+	m_PreviewScale = std::min(std::max(scale, 0.0), 1.0);
+}
+
 void MediaPlayerStateMachine::receiveGoToFrame(int frame) {
 	PStateGoToFrame* state = dynamic_cast<PStateGoToFrame*> (m_States.value(IPlayerState::PLAYER_STATES::STATE_GOTOFRAME));
 	state->setFrameNumber(frame);
@@ -147,19 +282,57 @@ void MediaPlayerStateMachine::updatePlayerParameter() {
 	m_PlayerParameters->m_TotalNumbFrames = m_CurrentPlayerState->m_ImageStream->numFrames();
 
 	m_PlayerParameters->m_CurrentFrame = m_CurrentPlayerState->getCurrentFrame();
+	m_PlayerParameters->m_TrackingFrame = m_CurrentPlayerState->m_ImageStream->trackingView(m_PlayerParameters->m_CurrentFrame);
+	m_PlayerParameters->m_PreviewFrame = buildPreview(m_PlayerParameters->m_CurrentFrame);
 	m_PlayerParameters->m_CurrentFrameNumber = m_CurrentPlayerState->getCurrentFrameNumber();
+	m_PlayerParameters->m_FrameDescriptor = m_CurrentPlayerState->m_ImageStream->currentDescriptor();
 	m_PlayerParameters->m_fpsSourceVideo = m_CurrentPlayerState->m_ImageStream->fps();
 	m_PlayerParameters->m_batchItems = m_CurrentPlayerState->getBatchItems();
+	m_PlayerParameters->m_FrameCacheHits = m_CurrentPlayerState->m_ImageStream->frameCacheHits();
+	m_PlayerParameters->m_FrameCacheMisses = m_CurrentPlayerState->m_ImageStream->frameCacheMisses();
+	const BioTracker::Core::FramePool::Statistics pool = m_CurrentPlayerState->m_ImageStream->framePoolStatistics();
+	m_PlayerParameters->m_FramePoolAllocated = pool.allocated;
+	m_PlayerParameters->m_FramePoolInUse = pool.inUse;
+	m_PlayerParameters->m_FramePoolHighWater = pool.highWater;
+	const BioTracker::Core::CaptureRing::Statistics capture = m_CurrentPlayerState->m_ImageStream->captureStatistics();
+	m_PlayerParameters->m_CaptureDropped = capture.dropped;
+	m_PlayerParameters->m_CaptureAgeMs = capture.ageMs;
+	m_PlayerParameters->m_CaptureMaxAgeMs = capture.maxAgeMs;
+}
+
+std::shared_ptr<cv::Mat> MediaPlayerStateMachine::buildPreview(const std::shared_ptr<cv::Mat> &frame) {
+	if (!frame || frame->empty() || m_PreviewScale <= 0.0 || m_PreviewScale >= 1.0) {
+		return frame;
+	}
+	const cv::Size size(std::max(1, cvRound(frame->cols * m_PreviewScale)), std::max(1, cvRound(frame->rows * m_PreviewScale)));
+	std::shared_ptr<cv::Mat> preview = m_PreviewPool->acquire(size, frame->type());
+	cv::resize(*frame, *preview, size, 0, 0, cv::INTER_AREA);
+	return preview;
 }
 
 void MediaPlayerStateMachine::emitSignals() {
 
+	{
+		std::lock_guard<std::mutex> lock(m_ConsumerMutex);
+		m_ParametersInUse = true;
+		m_ParametersEmitted = std::chrono::steady_clock::now();
+	}
 	Q_EMIT emitPlayerParameters(m_PlayerParameters);
 }
 
 void MediaPlayerStateMachine::setNextState(IPlayerState::PLAYER_STATES state) {
 	m_NextPlayerState = m_States.value(state);
 
+	// The play loop picks the next state up itself
+	if (m_InPlayLoop) {
+		// A step waiting for the consumer is woken to end the loop
+		std::lock_guard<std::mutex> lock(m_ConsumerMutex);
+		if (m_WaitingForConsumer) {
+			m_WaitingForConsumer = false;
+			schedulePlayLoop();
+		}
+		return;
+	}
 	Q_EMIT emitPlayerOperationDone();
 
 }
@@ -16,6 +16,7 @@
 #include "QString"
 #include "QMap"
 #include "QThread"
+#include "QRect"
 #include "opencv2/core/core.hpp"
 
 #include "View/VideoControllWidget.h"
@@ -29,6 +30,9 @@
 #include "View/CameraDevice.h"
 #include "util/Config.h"
 
+#include <chrono>
+#include <mutex>
+
 /**
  * The MediaPlayerStateMachine class is an IModel class and is responsible for the executing and setting Player Stats. The instance of this class runns in a separate Thread.
  */
@@ -46,6 +50,12 @@ class MediaPlayerStateMachine : public IModel {
 
   void setConfig(Config* cfg) { _cfg = cfg;};
 
+    /**
+     * Called by the consumer of emitPlayerParameters (from any thread) once it is done with the parameters.
+     * In the direct play loop the next parameters are not published before this call, it schedules the waiting loop step.
+     */
+    void releasePlayerParameters();
+
   public Q_SLOTS:
     /**
      * This SLOT is called by the MediaPlayer class. If this slot is triggered the next state will be executed.
@@ -55,6 +65,10 @@ class MediaPlayerStateMachine : public IModel {
     void receiveLoadVideoCommand(std::vector<boost::filesystem::path> files);
     void receiveLoadPictures(std::vector<boost::filesystem::path> files);
     void receiveLoadCameraDevice(CameraConfiguration conf);
+    void receiveLoadSynthetic(BioTracker::Core::SyntheticConfiguration conf);
+    void receiveLoadDirectory(boost::filesystem::path directory);
+    void receiveLoadPipe(boost::filesystem::path pipe);
+    void receiveLoadSharedMemory(QString name);
 
     void receivePrevFrameCommand();
     void receiveNextFramCommand();
@@ -63,6 +77,18 @@ class MediaPlayerStateMachine : public IModel {
     void receivePlayCommand();
     void receiveGoToFrame(int frame);
     void receiveTargetFps(double fps);
+    /**
+     * Restricts the frames handed to the tracker to region (in full frame pixels). An empty region disables cropping.
+     */
+    void receiveCropRegion(QRect region);
+    /**
+     * Switches the frames handed to the tracker to single channel. The display still gets color frames.
+     */
+    void receiveTrackingGrayscale(bool grayscale);
+    /**
+     * Frames are additionally downscaled by scale for the display (1: the display gets the full frame).
+     */
+    void receivePreviewScale(double scale);
 
 	  void receivetoggleRecordImageStream();
 
@@ -80,10 +106,38 @@ class MediaPlayerStateMachine : public IModel {
     void emitNextMediaInBatch(const std::string path);
     void emitNextMediaInBatchLoaded(const std::string path);
 
+  private Q_SLOTS:
+    /**
+     * One iteration of the direct play loop: decodes the next frame and publishes it once the consumer released the last one.
+     * Every iteration is a queued invocation, so commands and loads run between iterations and never inside one.
+     */
+    void playLoopStep();
+
   private:
+    /**
+     * Makes stream the played stream: applies the tracking view settings and hands it to all states.
+     */
+    void useStream(std::shared_ptr<BioTracker::Core::ImageStream> stream);
+
     void updatePlayerParameter();
+    /**
+     * Downscales frame to the preview scale, returns frame itself if no preview is needed.
+     */
+    std::shared_ptr<cv::Mat> buildPreview(const std::shared_ptr<cv::Mat> &frame);
     void emitSignals();
 
+    /**
+     * Plays in a loop on the player thread instead of one queued signal round trip per frame.
+     * Control commands queued to this thread are processed between frames.
+     * The loop ends when a command changes the next state.
+     */
+    void runPlayLoop();
+    void schedulePlayLoop();
+    /**
+     * Records the timing of one played frame and exports the averages to the player parameters.
+     */
+    void recordTiming(std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point operated);
+
 
   private:
     IPlayerState* m_CurrentPlayerState;
@@ -93,7 +147,29 @@ class MediaPlayerStateMachine : public IModel {
 
     playerParameters* m_PlayerParameters;
     std::shared_ptr<BioTracker::Core::ImageStream> m_stream;
+    cv::Rect m_CropRegion;
+    bool m_TrackingGrayscale = false;
+    double m_PreviewScale = 1.0;
+    std::shared_ptr<BioTracker::Core::FramePool> m_PreviewPool;
     Config *_cfg;
+
+    bool m_InPlayLoop = false;
+    // A frame of the play loop is decoded but not yet published
+    bool m_FramePending = false;
+    std::chrono::steady_clock::time_point m_FrameBegin;
+    std::chrono::steady_clock::time_point m_FrameOperated;
+    std::mutex m_ConsumerMutex;
+    // A play loop step waits for releasePlayerParameters
+    bool m_WaitingForConsumer = false;
+    bool m_ParametersInUse = false;
+    std::chrono::steady_clock::time_point m_ParametersEmitted;
+
+    // Per-frame timing while playing (moving averages in microseconds)
+    std::chrono::steady_clock::time_point m_LastCycle;
+    double m_CycleUs = 0;
+    double m_OperateUs = 0;
+    double m_ConsumerUs = 0;
+    size_t m_TimedFrames = 0;
 };
 
 
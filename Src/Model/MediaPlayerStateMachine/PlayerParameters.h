@@ -8,6 +8,8 @@
 #ifndef PLAYERPARAMETERS_H
 #define PLAYERPARAMETERS_H
 
+#include "Model/FrameDescriptor.h"
+
 /**
  * The playerParameters struct holds all data types of the current MediaPlayer state.
  */
@@ -28,9 +30,36 @@ struct playerParameters {
 	std::string m_CurrentTitle;
     size_t m_CurrentFrameNumber;
     std::shared_ptr<cv::Mat> m_CurrentFrame;
+    // The current frame cropped to the tracking area (a view into m_CurrentFrame, see ImageStream::trackingView)
+    std::shared_ptr<cv::Mat> m_TrackingFrame;
+    // The current frame downscaled to the resolution the display needs (m_CurrentFrame if no preview is needed)
+    std::shared_ptr<cv::Mat> m_PreviewFrame;
+    // Timestamps and ids of the current frame, see LatencyTracer
+    BioTracker::Core::FrameDescriptor m_FrameDescriptor;
     double m_fpsSourceVideo;
     double m_fpsTarget;
     std::vector<std::string> m_batchItems;
+
+    // Decoded-frame cache statistics of the current stream
+    size_t m_FrameCacheHits;
+    size_t m_FrameCacheMisses;
+
+    // Frame buffer pool statistics of the current stream
+    size_t m_FramePoolAllocated;
+    size_t m_FramePoolInUse;
+    size_t m_FramePoolHighWater;
+
+    // Capture statistics of live streams
+    size_t m_CaptureDropped;
+    double m_CaptureAgeMs;
+    double m_CaptureMaxAgeMs;
+
+    // Per-frame timing of the player while playing (moving averages in microseconds):
+    // a whole frame, the state operation (decode), the consumer of these parameters and the remaining overhead
+    double m_PlayerCycleUs;
+    double m_PlayerOperateUs;
+    double m_PlayerConsumerUs;
+    double m_PlayerOverheadUs;
 };
 
 #endif // PLAYERPARAMETERS_H
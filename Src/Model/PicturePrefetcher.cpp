@@ -0,0 +1,97 @@
+#include "PicturePrefetcher.h"
+
+#include <algorithm>
+
+namespace BioTracker {
+	namespace Core {
+
+		PicturePrefetcher::PicturePrefetcher(ReadFunction read, size_t workers)
+			: m_read(std::move(read))
+			, m_running(true)
+			, m_generation(0) {
+			for (size_t i = 0; i < std::max<size_t>(workers, 1); i++) {
+				m_workers.emplace_back(&PicturePrefetcher::run, this);
+			}
+		}
+
+		PicturePrefetcher::~PicturePrefetcher() {
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_running = false;
+				m_queue.clear();
+			}
+			m_jobQueued.notify_all();
+			for (std::thread &worker : m_workers) {
+				worker.join();
+			}
+		}
+
+		void PicturePrefetcher::request(size_t index) {
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (!m_requested.insert(index).second) {
+					return;
+				}
+				m_queue.push_back(index);
+			}
+			m_jobQueued.notify_one();
+		}
+
+		std::shared_ptr<cv::Mat> PicturePrefetcher::take(size_t index) {
+			std::unique_lock<std::mutex> lock(m_mutex);
+			if (m_requested.find(index) == m_requested.end()) {
+				return nullptr;
+			}
+			m_pictureRead.wait(lock, [this, index] {
+				return m_ready.find(index) != m_ready.end() || m_requested.find(index) == m_requested.end();
+			});
+
+			auto it = m_ready.find(index);
+			if (it == m_ready.end()) {
+				return nullptr;
+			}
+			std::shared_ptr<cv::Mat> picture = std::move(it->second);
+			m_ready.erase(it);
+			m_requested.erase(index);
+			return picture;
+		}
+
+		void PicturePrefetcher::cancel() {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_generation++;
+			m_queue.clear();
+			m_requested.clear();
+			m_ready.clear();
+		}
+
+		void PicturePrefetcher::run() {
+			for (;;) {
+				size_t index = 0;
+				uint64_t generation = 0;
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_jobQueued.wait(lock, [this] { return !m_running || !m_queue.empty(); });
+					if (!m_running) {
+						return;
+					}
+					index = m_queue.front();
+					m_queue.pop_front();
+					generation = m_generation;
+				}
+
+				std::shared_ptr<cv::Mat> picture = m_read(index);
+
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					// cancelled while reading: the picture belongs to the old position
+					if (generation != m_generation) {
+						continue;
+					}
+					m_ready[index] = picture ? std::move(picture) : std::make_shared<cv::Mat>();
+				}
+				m_pictureRead.notify_all();
+			}
+		}
+
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace BioTracker {
+namespace Core {
+
+/**
+ * The PicturePrefetcher reads pictures ahead of the play head on a fixed pool of worker threads.
+ * Pictures are requested by index and taken in any order. After a seek the outstanding requests are cancelled:
+ * queued reads are dropped and reads already running are discarded when they finish, nobody waits for them.
+ */
+class PicturePrefetcher {
+public:
+	using ReadFunction = std::function<std::shared_ptr<cv::Mat>(size_t index)>;
+
+	/**
+	 * @param read function reading the picture of an index, called on the worker threads
+	 * @param workers number of worker threads
+	 */
+	PicturePrefetcher(ReadFunction read, size_t workers);
+	~PicturePrefetcher();
+
+	/**
+	 * Queues the picture of index unless it is already queued, being read or read.
+	 */
+	void request(size_t index);
+
+	/**
+	 * Returns the picture of index, waiting for it if it is queued or being read.
+	 * @return nullptr if index was not requested (or was cancelled)
+	 */
+	std::shared_ptr<cv::Mat> take(size_t index);
+
+	/**
+	 * Drops all requests without waiting for the reads in progress.
+	 */
+	void cancel();
+
+private:
+	void run();
+
+	ReadFunction m_read;
+	bool m_running;
+	uint64_t m_generation;
+	std::deque<size_t> m_queue;
+	std::set<size_t> m_requested;
+	std::map<size_t, std::shared_ptr<cv::Mat>> m_ready;
+	std::mutex m_mutex;
+	std::condition_variable m_jobQueued;
+	std::condition_variable m_pictureRead;
+	std::vector<std::thread> m_workers;
+};
+
+}
+}
@@ -0,0 +1,84 @@
+#include "RawFrameFile.h"
+
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <opencv2/opencv.hpp>
+
+#include "util/Exceptions.h"
+
+namespace BioTracker {
+	namespace Core {
+
+		namespace {
+			const uint64_t PAGE_ALIGNMENT = 4096;
+		}
+
+		bool isRawFrameFile(const boost::filesystem::path &file) {
+			return boost::algorithm::iequals(file.extension().string(), RAW_FRAME_EXTENSION);
+		}
+
+		uint64_t convertVideoToRawFrameFile(const boost::filesystem::path &video, const boost::filesystem::path &target, bool timestamps) {
+			if (!boost::filesystem::exists(video)) {
+				throw file_not_found("Could not find file " + video.string());
+			}
+			cv::VideoCapture capture(video.string());
+			if (!capture.isOpened()) {
+				throw video_open_error("Could not open video " + video.string());
+			}
+
+			std::ofstream out(target.string(), std::ios::binary | std::ios::trunc);
+			if (!out) {
+				throw video_open_error("Could not write " + target.string());
+			}
+
+			RawFrameHeader header;
+			std::memset(&header, 0, sizeof(header));
+			std::memcpy(header.magic, RAW_FRAME_MAGIC, sizeof(header.magic));
+			header.version = RAW_FRAME_VERSION;
+			header.fps = capture.get(cv::CAP_PROP_FPS);
+			header.dataOffset = PAGE_ALIGNMENT;
+
+			// the header is rewritten once the frame count is known
+			out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+			out.seekp(static_cast<std::streamoff>(header.dataOffset));
+
+			std::vector<int64_t> frameTimestamps;
+			cv::Mat frame;
+			while (capture.read(frame) && !frame.empty()) {
+				if (header.frameCount == 0) {
+					header.width = frame.cols;
+					header.height = frame.rows;
+					header.type = frame.type();
+					header.frameBytes = frame.total() * frame.elemSize();
+				}
+				else if (frame.cols != static_cast<int>(header.width) || frame.rows != static_cast<int>(header.height) || frame.type() != header.type) {
+					throw video_open_error("Frame geometry changes within " + video.string());
+				}
+				if (!frame.isContinuous()) {
+					frame = frame.clone();
+				}
+				out.write(reinterpret_cast<const char *>(frame.data), static_cast<std::streamsize>(header.frameBytes));
+				if (timestamps) {
+					frameTimestamps.push_back(static_cast<int64_t>(capture.get(cv::CAP_PROP_POS_MSEC) * 1000.0));
+				}
+				header.frameCount++;
+			}
+
+			if (timestamps && header.frameCount > 0) {
+				header.timestampOffset = header.dataOffset + header.frameCount * header.frameBytes;
+				out.write(reinterpret_cast<const char *>(frameTimestamps.data()), static_cast<std::streamsize>(frameTimestamps.size() * sizeof(int64_t)));
+			}
+
+			out.seekp(0);
+			out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+			if (!out) {
+				throw video_open_error("Could not write " + target.string());
+			}
+			return header.frameCount;
+		}
+
+	}
+}
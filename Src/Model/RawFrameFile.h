@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <boost/filesystem.hpp>
+
+namespace BioTracker {
+namespace Core {
+
+/**
+ * Header of the uncompressed frame container ("*.btraw").
+ *
+ * The file starts with this header, followed by frameCount frames of frameBytes bytes each starting at dataOffset
+ * (aligned to the page size, so every frame can be mapped without copying). If timestampOffset is not 0,
+ * frameCount signed 64 bit timestamps (microseconds since the start of the source) follow at that offset.
+ * All values are stored in the byte order of the writing machine.
+ */
+struct RawFrameHeader {
+	char     magic[8];
+	uint32_t version;
+	uint32_t width;
+	uint32_t height;
+	int32_t  type;			///< OpenCV type of the frames, e.g. CV_8UC3
+	uint64_t frameCount;
+	uint64_t frameBytes;
+	uint64_t dataOffset;
+	uint64_t timestampOffset;
+	double   fps;
+};
+
+static const char RAW_FRAME_MAGIC[8] = { 'B', 'T', 'R', 'A', 'W', 0, 0, 0 };
+static const uint32_t RAW_FRAME_VERSION = 1;
+static const std::string RAW_FRAME_EXTENSION = ".btraw";
+
+/**
+ * @return true, if the file has the raw frame container extension
+ */
+bool isRawFrameFile(const boost::filesystem::path &file);
+
+/**
+ * Decodes a video with OpenCV and writes all of its frames to a raw frame container.
+ * @throw file_not_found when the video does not exist
+ * @throw video_open_error when the video cannot be opened or the target cannot be written
+ * @return the number of frames written
+ */
+uint64_t convertVideoToRawFrameFile(const boost::filesystem::path &video, const boost::filesystem::path &target, bool timestamps = true);
+
+}
+}
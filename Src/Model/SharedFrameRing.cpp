@@ -0,0 +1,305 @@
+#include "SharedFrameRing.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace BioTracker {
+	namespace Core {
+
+		namespace {
+			const uint64_t PAGE = 4096;
+
+			uint64_t alignToPage(uint64_t offset) {
+				return (offset + PAGE - 1) / PAGE * PAGE;
+			}
+
+			// the futex is shared between processes, it must not be FUTEX_PRIVATE
+			void wake(std::atomic<uint32_t> *word) {
+#ifdef __linux__
+				syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#else
+				(void)word;
+#endif
+			}
+
+			void wait(const std::atomic<uint32_t> *word, uint32_t expected, std::chrono::milliseconds timeout) {
+#ifdef __linux__
+				timespec ts;
+				ts.tv_sec = static_cast<time_t>(timeout.count() / 1000);
+				ts.tv_nsec = static_cast<long>(timeout.count() % 1000) * 1000000;
+				syscall(SYS_futex, reinterpret_cast<const uint32_t *>(word), FUTEX_WAIT, expected, &ts, nullptr, 0);
+#else
+				// no futex: poll
+				(void)word;
+				(void)expected;
+				std::this_thread::sleep_for(std::min(timeout, std::chrono::milliseconds(1)));
+#endif
+			}
+
+			int64_t currentProcessId() {
+#ifdef _WIN32
+				return _getpid();
+#else
+				return getpid();
+#endif
+			}
+		}
+
+		SharedFrameRing::SharedFrameRing(const std::string &name, bool owner)
+			: m_name(name)
+			, m_owner(owner)
+			, m_cursor(-1) {
+		}
+
+		SharedFrameRing::~SharedFrameRing() {
+			if (m_cursor >= 0) {
+				SharedRingCursor &cursor = header()->cursors[m_cursor];
+				cursor.active.store(0, std::memory_order_release);
+				wake(&cursor.consumed);
+			}
+			if (m_owner) {
+				// consumers waiting for the next frame end instead
+				close();
+				boost::interprocess::shared_memory_object::remove(m_name.c_str());
+			}
+		}
+
+		std::shared_ptr<SharedFrameRing> SharedFrameRing::create(const std::string &name, uint32_t slotCount, uint64_t slotBytes, uint32_t consumers) {
+			using namespace boost::interprocess;
+			if (slotCount == 0 || slotBytes == 0) {
+				throw std::runtime_error("A frame ring needs at least one slot of at least one byte");
+			}
+			if (consumers > SHARED_RING_MAX_CONSUMERS) {
+				throw std::runtime_error("A frame ring waits for at most " + std::to_string(SHARED_RING_MAX_CONSUMERS) + " consumers");
+			}
+			std::shared_ptr<SharedFrameRing> ring(new SharedFrameRing(name, true));
+			const uint64_t dataOffset = alignToPage(sizeof(SharedRingHeader) + slotCount * sizeof(SharedSlotHeader));
+			slotBytes = alignToPage(slotBytes);
+			try {
+				shared_memory_object::remove(name.c_str());
+				ring->m_memory = shared_memory_object(create_only, name.c_str(), read_write);
+				ring->m_memory.truncate(static_cast<offset_t>(dataOffset + slotCount * slotBytes));
+				ring->m_region = mapped_region(ring->m_memory, read_write);
+			}
+			catch (const interprocess_exception &e) {
+				throw std::runtime_error("Could not create shared memory " + name + ": " + e.what());
+			}
+
+			SharedRingHeader *header = ring->header();
+			std::memcpy(header->magic, SHARED_RING_MAGIC, sizeof(header->magic));
+			header->version = SHARED_RING_VERSION;
+			header->slotCount = slotCount;
+			header->slotBytes = slotBytes;
+			header->dataOffset = dataOffset;
+			header->closed.store(0, std::memory_order_relaxed);
+			header->consumers = consumers;
+			header->attached.store(0, std::memory_order_relaxed);
+			// unclaimed cursors are waited for as well, a consumer may claim its cursor after the first frames
+			for (uint32_t i = 0; i < SHARED_RING_MAX_CONSUMERS; i++) {
+				header->cursors[i].consumed.store(0, std::memory_order_relaxed);
+				header->cursors[i].active.store(i < consumers ? 1 : 0, std::memory_order_relaxed);
+				header->cursors[i].pid.store(0, std::memory_order_relaxed);
+			}
+			header->published.store(0, std::memory_order_release);
+			for (uint32_t i = 0; i < slotCount; i++) {
+				ring->slot(i)->sequence.store(0, std::memory_order_relaxed);
+			}
+			return ring;
+		}
+
+		std::shared_ptr<SharedFrameRing> SharedFrameRing::attach(const std::string &name, bool claim) {
+			using namespace boost::interprocess;
+			std::shared_ptr<SharedFrameRing> ring(new SharedFrameRing(name, false));
+			// a cursor is written by the consumer
+			const boost::interprocess::mode_t mode = claim ? read_write : read_only;
+			try {
+				ring->m_memory = shared_memory_object(open_only, name.c_str(), mode);
+				ring->m_region = mapped_region(ring->m_memory, mode);
+			}
+			catch (const interprocess_exception &e) {
+				throw std::runtime_error("Could not open shared memory " + name + ": " + e.what());
+			}
+
+			SharedRingHeader *header = ring->header();
+			if (ring->m_region.get_size() < sizeof(SharedRingHeader)
+				|| std::memcmp(header->magic, SHARED_RING_MAGIC, sizeof(header->magic)) != 0
+				|| header->version != SHARED_RING_VERSION
+				|| header->consumers > SHARED_RING_MAX_CONSUMERS
+				|| ring->m_region.get_size() < header->dataOffset + header->slotCount * header->slotBytes) {
+				throw std::runtime_error(name + " is no BioTracker frame ring");
+			}
+
+			// without a free cursor the consumer reads like the consumer of a lossy ring
+			if (claim) {
+				uint32_t index = header->attached.load(std::memory_order_acquire);
+				while (index < header->consumers && !header->attached.compare_exchange_weak(index, index + 1, std::memory_order_acq_rel)) {
+				}
+				if (index < header->consumers) {
+					header->cursors[index].pid.store(currentProcessId(), std::memory_order_release);
+					ring->m_cursor = static_cast<int>(index);
+				}
+			}
+			return ring;
+		}
+
+		bool SharedFrameRing::publish(const cv::Mat &frame, int64_t timestamp) {
+			const uint64_t bytes = frame.total() * frame.elemSize();
+			if (bytes > header()->slotBytes) {
+				return false;
+			}
+			const uint32_t n = header()->published.load(std::memory_order_relaxed);
+			SharedSlotHeader *s = slot(n);
+
+			s->sequence.store(2 * static_cast<uint64_t>(n) + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			cv::Mat target(frame.rows, frame.cols, frame.type(), slotData(n));
+			frame.copyTo(target);
+			s->width = frame.cols;
+			s->height = frame.rows;
+			s->type = frame.type();
+			s->step = static_cast<int32_t>(target.step[0]);
+			s->timestamp = timestamp;
+			s->sequence.store(2 * static_cast<uint64_t>(n) + 2, std::memory_order_release);
+
+			header()->published.store(n + 1, std::memory_order_release);
+			wake(&header()->published);
+			return true;
+		}
+
+		uint32_t SharedFrameRing::slotCount() const {
+			return header()->slotCount;
+		}
+
+		uint32_t SharedFrameRing::published() const {
+			return header()->published.load(std::memory_order_acquire);
+		}
+
+		bool SharedFrameRing::waitForPublished(uint32_t known, std::chrono::milliseconds timeout) const {
+			const auto deadline = std::chrono::steady_clock::now() + timeout;
+			while (published() == known && !closed()) {
+				const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+				if (left.count() <= 0) {
+					return false;
+				}
+				wait(&header()->published, known, left);
+			}
+			return true;
+		}
+
+		bool SharedFrameRing::read(uint32_t n, cv::Mat &view, int64_t &timestamp) const {
+			const SharedSlotHeader *s = slot(n);
+			const uint64_t expected = 2 * static_cast<uint64_t>(n) + 2;
+			if (s->sequence.load(std::memory_order_acquire) != expected) {
+				return false;
+			}
+			const int width = s->width;
+			const int height = s->height;
+			const int type = s->type;
+			const size_t step = static_cast<size_t>(s->step);
+			timestamp = s->timestamp;
+			std::atomic_thread_fence(std::memory_order_acquire);
+			// overwritten while the metadata was read
+			if (s->sequence.load(std::memory_order_relaxed) != expected) {
+				return false;
+			}
+			if (width <= 0 || height <= 0 || step * static_cast<uint64_t>(height) > header()->slotBytes) {
+				return false;
+			}
+			// the mapping is read only, the view must not be written to
+			view = cv::Mat(height, width, type, slotData(n), step);
+			return true;
+		}
+
+		void SharedFrameRing::close() {
+			header()->closed.store(1, std::memory_order_release);
+			wake(&header()->published);
+		}
+
+		bool SharedFrameRing::closed() const {
+			return header()->closed.load(std::memory_order_acquire) != 0;
+		}
+
+		bool SharedFrameRing::waitForSpace(std::chrono::milliseconds timeout) const {
+			const auto deadline = std::chrono::steady_clock::now() + timeout;
+			for (;;) {
+				const uint32_t n = header()->published.load(std::memory_order_relaxed);
+				const SharedRingCursor *slowest = nullptr;
+				uint32_t consumed = 0;
+				for (uint32_t i = 0; i < header()->consumers && !slowest; i++) {
+					const SharedRingCursor &cursor = header()->cursors[i];
+					consumed = cursor.consumed.load(std::memory_order_acquire);
+					// unsigned difference, the counters may wrap
+					if (cursor.active.load(std::memory_order_acquire) && n - consumed >= header()->slotCount) {
+						slowest = &cursor;
+					}
+				}
+				if (!slowest) {
+					return true;
+				}
+				const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+				if (left.count() <= 0) {
+					return false;
+				}
+				wait(&slowest->consumed, consumed, left);
+			}
+		}
+
+		void SharedFrameRing::detachConsumer(int64_t pid) {
+			SharedRingHeader *h = header();
+			const uint32_t attached = std::min(h->attached.load(std::memory_order_acquire), h->consumers);
+			for (uint32_t i = 0; i < attached; i++) {
+				if (h->cursors[i].pid.load(std::memory_order_acquire) == pid) {
+					h->cursors[i].active.store(0, std::memory_order_release);
+					return;
+				}
+			}
+			// the consumer exited before it claimed its cursor: nobody will claim it any more
+			uint32_t index = h->attached.load(std::memory_order_acquire);
+			while (index < h->consumers && !h->attached.compare_exchange_weak(index, index + 1, std::memory_order_acq_rel)) {
+			}
+			if (index < h->consumers) {
+				h->cursors[index].active.store(0, std::memory_order_release);
+			}
+		}
+
+		bool SharedFrameRing::isConsumer() const {
+			return m_cursor >= 0;
+		}
+
+		void SharedFrameRing::release(uint32_t n) {
+			if (m_cursor < 0) {
+				return;
+			}
+			SharedRingCursor &cursor = header()->cursors[m_cursor];
+			cursor.consumed.store(n + 1, std::memory_order_release);
+			wake(&cursor.consumed);
+		}
+
+		SharedRingHeader *SharedFrameRing::header() const {
+			return static_cast<SharedRingHeader *>(m_region.get_address());
+		}
+
+		SharedSlotHeader *SharedFrameRing::slot(uint32_t n) const {
+			return reinterpret_cast<SharedSlotHeader *>(header() + 1) + n % header()->slotCount;
+		}
+
+		uint8_t *SharedFrameRing::slotData(uint32_t n) const {
+			return static_cast<uint8_t *>(m_region.get_address()) + header()->dataOffset + (n % header()->slotCount) * header()->slotBytes;
+		}
+
+	}
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace BioTracker {
+namespace Core {
+
+const char SHARED_RING_MAGIC[8] = { 'B', 'T', 'S', 'H', 'R', 'I', 'N', 'G' };
+const uint32_t SHARED_RING_VERSION = 2;
+const uint32_t SHARED_RING_MAX_CONSUMERS = 32;
+
+/**
+ * Segment header of a shared memory frame ring. The segment is laid out as
+ *   SharedRingHeader | SharedSlotHeader[slotCount] | slot data (starting at dataOffset, slotBytes per slot)
+ * All fields are little endian, the atomics are plain 32/64 bit integers in memory.
+ *
+ * Publishing frame n (counted from 0) into slot n % slotCount:
+ *   1. slot.sequence = 2n+1 (odd: being written)
+ *   2. write pixels and the slot's metadata
+ *   3. slot.sequence = 2n+2 (release)
+ *   4. published = n+1 (release), then wake the waiters on &published (futex on Linux)
+ * A reader checks that slot.sequence is 2n+2 before and after reading the metadata.
+ *
+ * A ring created for consumers > 0 is lossless: every consumer claims a cursor and sets its consumed counter
+ * (then wakes &consumed) once it is done with a frame, the producer waits until the slot is consumed by all active
+ * cursors before overwriting it. closed is set (and &published woken) after the last frame.
+ */
+struct SharedRingCursor {
+	std::atomic<uint32_t> consumed;	///< frames the consumer is done with, the futex word of the producer
+	std::atomic<uint32_t> active;	///< 0 once the consumer detached, it is not waited for any more
+	std::atomic<int64_t> pid;		///< process of the consumer
+};
+
+struct SharedRingHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t slotCount;
+	uint64_t slotBytes;
+	uint64_t dataOffset;
+	std::atomic<uint32_t> published;	///< number of frames published so far, the futex word
+	std::atomic<uint32_t> closed;		///< 1 once the producer published its last frame
+	uint32_t consumers;					///< number of cursors, 0 for a ring that does not wait for its consumers
+	std::atomic<uint32_t> attached;		///< cursors claimed so far
+	SharedRingCursor cursors[SHARED_RING_MAX_CONSUMERS];
+};
+
+struct SharedSlotHeader {
+	std::atomic<uint64_t> sequence;
+	int32_t width;
+	int32_t height;
+	int32_t type;		///< OpenCV type, e.g. CV_8UC3 (16) or CV_8UC1 (0)
+	int32_t step;		///< bytes per row
+	int64_t timestamp;	///< capture time in microseconds of CLOCK_MONOTONIC, 0 if unknown
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free && std::atomic<int64_t>::is_always_lock_free,
+	"the ring's atomics are shared between processes");
+
+/**
+ * The SharedFrameRing hands decoded frames between processes through a POSIX shared memory segment without copying.
+ * Producers create the ring and publish frames. Consumers attach to it and read frames as views into the segment.
+ * A view stays valid until the producer has published slotCount more frames, so the ring needs enough slots to
+ * cover the frames a consumer holds at a time. A ring created for a number of consumers waits for them instead,
+ * so every consumer gets every frame (e.g. one decode shared by several tracking processes).
+ */
+class SharedFrameRing {
+public:
+	/**
+	 * Creates (or replaces) the segment name. It is removed again when the ring is destroyed.
+	 * @param consumers number of consumers the producer waits for (see waitForSpace), 0: none
+	 * @throw std::runtime_error if the segment can not be created
+	 */
+	static std::shared_ptr<SharedFrameRing> create(const std::string &name, uint32_t slotCount, uint64_t slotBytes, uint32_t consumers = 0);
+
+	/**
+	 * @param claim claim a free cursor of a lossless ring, the consumer then has to release every frame it read
+	 * @throw std::runtime_error if there is no valid ring segment called name
+	 */
+	static std::shared_ptr<SharedFrameRing> attach(const std::string &name, bool claim = false);
+
+	~SharedFrameRing();
+
+	/**
+	 * Copies frame into the next slot and wakes the consumers. The producer of a lossless ring calls waitForSpace first.
+	 * @param timestamp capture time in microseconds of CLOCK_MONOTONIC (std::chrono::steady_clock), 0 if unknown
+	 * @return false if the frame does not fit into a slot
+	 */
+	bool publish(const cv::Mat &frame, int64_t timestamp);
+
+	uint32_t slotCount() const;
+
+	/**
+	 * @return the number of frames published so far
+	 */
+	uint32_t published() const;
+
+	/**
+	 * Waits until more than known frames are published, at most timeout.
+	 * @return false on timeout
+	 */
+	bool waitForPublished(uint32_t known, std::chrono::milliseconds timeout) const;
+
+	/**
+	 * Wraps frame n as a view into the segment (no copy).
+	 * @return false if the frame is not (or no longer) in the ring
+	 */
+	bool read(uint32_t n, cv::Mat &view, int64_t &timestamp) const;
+
+	/**
+	 * Producer: marks the end of the stream and wakes the consumers.
+	 */
+	void close();
+
+	/**
+	 * @return true once the producer published its last frame
+	 */
+	bool closed() const;
+
+	/**
+	 * Producer: waits until the slot of the next frame is released by every active cursor, at most timeout.
+	 * @return false on timeout
+	 */
+	bool waitForSpace(std::chrono::milliseconds timeout) const;
+
+	/**
+	 * Producer: stops waiting for the consumer running in process pid, e.g. because it exited.
+	 */
+	void detachConsumer(int64_t pid);
+
+	/**
+	 * @return true if this consumer holds a cursor
+	 */
+	bool isConsumer() const;
+
+	/**
+	 * Consumer: done with frame n and all frames before it, the producer may overwrite their slots.
+	 */
+	void release(uint32_t n);
+
+private:
+	SharedFrameRing(const std::string &name, bool owner);
+
+	SharedRingHeader *header() const;
+	SharedSlotHeader *slot(uint32_t n) const;
+	uint8_t *slotData(uint32_t n) const;
+
+	std::string m_name;
+	bool m_owner;
+	int m_cursor;
+	boost::interprocess::shared_memory_object m_memory;
+	boost::interprocess::mapped_region m_region;
+};
+
+}
+}
@@ -0,0 +1,161 @@
+#include "SyntheticScene.h"
+
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/algorithm/string.hpp>
+
+namespace BioTracker {
+	namespace Core {
+
+		namespace {
+			const cv::Scalar BACKGROUND(40, 40, 40);
+			const cv::Scalar FOREGROUND(220, 220, 220);
+
+			/**
+			* Position of a point moving with constant speed between lo and hi, reflected at both ends.
+			* direction is set to -1 while the point moves backwards.
+			*/
+			float bounce(float position, float lo, float hi, float &direction) {
+				const float length = std::max(hi - lo, 1.0f);
+				float m = std::fmod(position - lo, 2 * length);
+				if (m < 0) {
+					m += 2 * length;
+				}
+				direction = m <= length ? 1.0f : -1.0f;
+				return lo + (m <= length ? m : 2 * length - m);
+			}
+		}
+
+		SyntheticConfiguration SyntheticConfiguration::parse(const std::string &spec) {
+			SyntheticConfiguration conf;
+			std::vector<std::string> pairs;
+			boost::split(pairs, spec, boost::is_any_of(","), boost::token_compress_on);
+			for (std::string pair : pairs) {
+				boost::trim(pair);
+				if (pair.empty()) {
+					continue;
+				}
+				const size_t eq = pair.find('=');
+				if (eq == std::string::npos) {
+					throw std::invalid_argument("Malformed synthetic parameter: " + pair);
+				}
+				const std::string key = boost::to_lower_copy(pair.substr(0, eq));
+				const std::string value = pair.substr(eq + 1);
+				try {
+					if (key == "width")				conf.width = std::stoi(value);
+					else if (key == "height")		conf.height = std::stoi(value);
+					else if (key == "fps")			conf.fps = std::stod(value);
+					else if (key == "frames")		conf.frames = std::stoul(value);
+					else if (key == "count")		conf.count = std::stoul(value);
+					else if (key == "size")			conf.size = std::stod(value);
+					else if (key == "speed")		conf.speed = std::stod(value);
+					else if (key == "noise")		conf.noise = std::stod(value);
+					else if (key == "seed")			conf.seed = std::stoull(value);
+					else if (key == "groundtruth")	conf.groundTruth = value;
+					else if (key == "shape") {
+						if (value == "blob")			conf.shape = SyntheticShape::Blob;
+						else if (value == "ellipse")	conf.shape = SyntheticShape::Ellipse;
+						else if (value == "rect")		conf.shape = SyntheticShape::Rectangle;
+						else throw std::invalid_argument(value);
+					}
+					else {
+						throw std::invalid_argument("Unknown synthetic parameter: " + key);
+					}
+				}
+				catch (const std::logic_error &) {
+					throw std::invalid_argument("Invalid synthetic parameter: " + pair);
+				}
+			}
+			if (conf.width <= 0 || conf.height <= 0 || conf.fps <= 0) {
+				throw std::invalid_argument("Synthetic frame size and fps must be positive");
+			}
+			return conf;
+		}
+
+		SyntheticScene::SyntheticScene(const SyntheticConfiguration &conf)
+			: m_conf(conf) {
+			cv::RNG rng(conf.seed);
+			for (size_t i = 0; i < conf.count; i++) {
+				Motion motion;
+				const float scale = static_cast<float>(rng.uniform(0.75, 1.25));
+				const float major = static_cast<float>(conf.size) * scale;
+				motion.size = conf.shape == SyntheticShape::Blob ? cv::Size2f(2 * major, 2 * major) : cv::Size2f(2 * major, major);
+				motion.start = cv::Point2f(static_cast<float>(rng.uniform(0.0, static_cast<double>(conf.width))),
+					static_cast<float>(rng.uniform(0.0, static_cast<double>(conf.height))));
+				const double heading = rng.uniform(0.0, 2 * CV_PI);
+				const double speed = conf.speed * rng.uniform(0.5, 1.5);
+				motion.velocity = cv::Point2f(static_cast<float>(speed * std::cos(heading)), static_cast<float>(speed * std::sin(heading)));
+				m_motions.push_back(motion);
+			}
+		}
+
+		std::vector<SyntheticObject> SyntheticScene::objects(size_t frame_number) const {
+			std::vector<SyntheticObject> objects;
+			objects.reserve(m_motions.size());
+			const float t = static_cast<float>(frame_number);
+			for (size_t i = 0; i < m_motions.size(); i++) {
+				const Motion &motion = m_motions[i];
+				const float margin = motion.size.width / 2;
+				float dx, dy;
+				SyntheticObject object;
+				object.id = i;
+				object.center.x = bounce(motion.start.x + motion.velocity.x * t, margin, m_conf.width - margin, dx);
+				object.center.y = bounce(motion.start.y + motion.velocity.y * t, margin, m_conf.height - margin, dy);
+				object.size = motion.size;
+				object.angle = static_cast<float>(std::atan2(dy * motion.velocity.y, dx * motion.velocity.x) * 180.0 / CV_PI);
+				objects.push_back(object);
+			}
+			return objects;
+		}
+
+		void SyntheticScene::render(size_t frame_number, cv::Mat &frame) const {
+			frame.create(m_conf.height, m_conf.width, CV_8UC3);
+			frame.setTo(BACKGROUND);
+
+			for (const SyntheticObject &object : objects(frame_number)) {
+				switch (m_conf.shape) {
+				case SyntheticShape::Blob:
+					cv::circle(frame, object.center, cvRound(object.size.width / 2), FOREGROUND, cv::FILLED, cv::LINE_AA);
+					break;
+				case SyntheticShape::Ellipse:
+					cv::ellipse(frame, cv::RotatedRect(object.center, object.size, object.angle), FOREGROUND, cv::FILLED, cv::LINE_AA);
+					break;
+				case SyntheticShape::Rectangle: {
+					cv::Point2f corners[4];
+					cv::RotatedRect(object.center, object.size, object.angle).points(corners);
+					std::vector<cv::Point> polygon(corners, corners + 4);
+					cv::fillConvexPoly(frame, polygon, FOREGROUND, cv::LINE_AA);
+					break;
+				}
+				}
+			}
+
+			if (m_conf.noise > 0) {
+				// seeded per frame, so noise does not depend on the order frames are rendered in
+				cv::RNG rng(m_conf.seed ^ (static_cast<uint64_t>(frame_number + 1) * 0x9E3779B97F4A7C15ULL));
+				cv::Mat noise(frame.size(), CV_16SC3);
+				rng.fill(noise, cv::RNG::NORMAL, 0, m_conf.noise);
+				cv::add(frame, noise, frame, cv::noArray(), CV_8UC3);
+			}
+		}
+
+		bool SyntheticScene::writeGroundTruth(const std::string &path) const {
+			std::ofstream out(path);
+			if (!out) {
+				return false;
+			}
+			out << "frame,id,x,y,width,height,angle\n";
+			for (size_t frame_number = 0; frame_number < m_conf.frames; frame_number++) {
+				for (const SyntheticObject &object : objects(frame_number)) {
+					out << frame_number << ',' << object.id << ',' << object.center.x << ',' << object.center.y << ','
+						<< object.size.width << ',' << object.size.height << ',' << object.angle << '\n';
+				}
+			}
+			return static_cast<bool>(out);
+		}
+
+	}
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+namespace BioTracker {
+namespace Core {
+
+enum class SyntheticShape {
+	Blob,
+	Ellipse,
+	Rectangle
+};
+
+/**
+ * Parameters of a synthetic scene. The scene is fully determined by these values.
+ */
+struct SyntheticConfiguration {
+	int width = 1920;
+	int height = 1080;
+	double fps = 30;
+	size_t frames = 1000;
+	size_t count = 10;				///< number of objects
+	SyntheticShape shape = SyntheticShape::Ellipse;
+	double size = 20;				///< object size (major radius) in pixels
+	double speed = 3;				///< mean object speed in pixels per frame
+	double noise = 0;				///< standard deviation of the gaussian pixel noise
+	uint64_t seed = 1;
+	std::string groundTruth;		///< if set, the ground truth of all frames is written to this CSV file
+
+	/**
+	 * Parses a comma separated list of key=value pairs, e.g. "width=3840,height=2160,count=50,shape=blob,seed=7".
+	 * Keys: width, height, fps, frames, count, shape (blob|ellipse|rect), size, speed, noise, seed, groundtruth.
+	 * @throw std::invalid_argument on unknown keys or malformed values
+	 */
+	static SyntheticConfiguration parse(const std::string &spec);
+};
+
+/**
+ * Position of one object in one frame.
+ */
+struct SyntheticObject {
+	size_t id;
+	cv::Point2f center;		///< pixels
+	cv::Size2f size;		///< full axes in pixels
+	float angle;			///< heading in degrees
+};
+
+/**
+ * Renders moving objects bouncing off the frame borders. Each frame is computed directly from its frame number,
+ * so frames can be rendered in any order and the same configuration always yields the same frames.
+ */
+class SyntheticScene {
+public:
+	explicit SyntheticScene(const SyntheticConfiguration &conf);
+
+	const SyntheticConfiguration &configuration() const {
+		return m_conf;
+	}
+
+	/**
+	 * @return the ground truth of frame_number
+	 */
+	std::vector<SyntheticObject> objects(size_t frame_number) const;
+
+	/**
+	 * Renders frame_number into frame (CV_8UC3, allocated if needed).
+	 */
+	void render(size_t frame_number, cv::Mat &frame) const;
+
+	/**
+	 * Writes the ground truth of all frames as CSV (frame, id, x, y, width, height, angle).
+	 * @return false if the file could not be written
+	 */
+	bool writeGroundTruth(const std::string &path) const;
+
+private:
+	struct Motion {
+		cv::Point2f start;
+		cv::Point2f velocity;
+		cv::Size2f size;
+	};
+
+	SyntheticConfiguration m_conf;
+	std::vector<Motion> m_motions;
+};
+
+}
+}
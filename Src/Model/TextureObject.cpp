@@ -9,7 +9,7 @@ TextureObject::TextureObject(QObject *parent, QString name) :
     m_texture = QImage(1, 1, QImage::Format_RGB888);
 }
 
-void TextureObject::set(const cv::Mat &img) {
+void TextureObject::set(const cv::Mat &img, QSize sourceSize) {
 	//TODO Andi this cv::Mat is null sometimes when using the camera!?
 	if (&img == NULL)
 		return;
@@ -48,6 +48,7 @@ void TextureObject::set(const cv::Mat &img) {
                     static_cast<int>(m_img.step),
                     QImage::Format_RGB888
                 );
+    m_sourceSize = sourceSize;
 
     Q_EMIT notifyView();
 }
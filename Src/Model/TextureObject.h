@@ -14,6 +14,7 @@
 #include <opencv2/opencv.hpp>
 #include "QImage"
 #include "QString"
+#include "QSize"
 
 /**
  * The TextureObject class in an IModel class. It is responsible for converting cv::Mats to QImages. These QImages are then displayed in the TextureObjectView.
@@ -24,7 +25,10 @@ class TextureObject : public IModel {
   public:
     explicit TextureObject(QObject* parent = 0, QString name = "NoName");
 
-    void set(cv::Mat const& img);
+    /**
+     * @param sourceSize size of the frame img was downscaled from, invalid if img is the frame itself
+     */
+    void set(cv::Mat const& img, QSize sourceSize = QSize());
     QString getName();
 
     QImage const& get() const {
@@ -36,11 +40,18 @@ class TextureObject : public IModel {
     int height() const {
         return m_texture.height();
     }
+    /**
+     * @return the size at which the texture is shown in the scene (frame pixels)
+     */
+    QSize sourceSize() const {
+        return m_sourceSize.isValid() ? m_sourceSize : m_texture.size();
+    }
 
   private:
     QString m_Name;
     cv::Mat m_img;
     QImage m_texture;
+    QSize m_sourceSize;
 };
 
 #endif // BIOTRACKER3TEXTUREOBJECT_H
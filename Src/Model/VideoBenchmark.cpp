@@ -0,0 +1,48 @@
+#include "VideoBenchmark.h"
+
+#include "Model/ImageStream.h"
+
+#include <chrono>
+#include <vector>
+
+namespace BioTracker {
+	namespace Core {
+
+		void benchmarkVideoBackends(Config *cfg, const boost::filesystem::path &video, size_t frames, std::ostream &out) {
+			// served from a cache or decoded ahead on another thread the frames would not measure the decoder
+			Config benchmarkCfg(*cfg);
+			benchmarkCfg.FrameCacheMB = 0;
+			benchmarkCfg.VideoPrefetchDepth = 0;
+
+			std::vector<std::pair<int, const char *>> backends = { { 0, "opencv" } };
+#if HAS_LIBAV
+			backends.emplace_back(1, "libav");
+#endif
+
+			for (const std::pair<int, const char *> &backend : backends) {
+				benchmarkCfg.VideoBackend = backend.first;
+
+				const auto opening = std::chrono::steady_clock::now();
+				std::shared_ptr<ImageStream> stream = make_ImageStream3Video(&benchmarkCfg, { video });
+				const auto decoding = std::chrono::steady_clock::now();
+				if (stream->type() == GuiParam::MediaType::NoMedia) {
+					out << backend.second << ": could not open " << video.string() << std::endl;
+					continue;
+				}
+
+				// the first frame is decoded when the stream is opened
+				size_t decoded = stream->currentFrameIsEmpty() ? 0 : 1;
+				while (decoded < frames && stream->nextFrame()) {
+					decoded++;
+				}
+				const auto done = std::chrono::steady_clock::now();
+
+				const double openMs = std::chrono::duration<double, std::milli>(decoding - opening).count();
+				const double seconds = std::chrono::duration<double>(done - decoding).count();
+				out << backend.second << ": open " << openMs << " ms, " << decoded << " frames in " << seconds << " s, "
+					<< (seconds > 0 ? decoded / seconds : 0) << " fps" << std::endl;
+			}
+		}
+
+	}
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "util/Config.h"
+
+#include <boost/filesystem.hpp>
+
+#include <ostream>
+
+namespace BioTracker {
+namespace Core {
+
+/**
+ * Decodes the first frames of video with every available video backend (Config::VideoBackend) and writes
+ * open time, frame count and throughput of each to out. The frame cache and prefetching are turned off, so the decoding
+ * itself is measured. All other settings (threads, gray) are taken from cfg.
+ */
+void benchmarkVideoBackends(Config *cfg, const boost::filesystem::path &video, size_t frames, std::ostream &out);
+
+}
+}
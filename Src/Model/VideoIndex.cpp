@@ -0,0 +1,231 @@
+#include "VideoIndex.h"
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <utility>
+
+#include <opencv2/opencv.hpp>
+#include <QDebug>
+
+#if HAS_LIBAV
+extern "C" {
+#include <libavformat/avformat.h>
+}
+#endif
+
+namespace BioTracker {
+	namespace Core {
+
+		namespace {
+			const std::string SIDECAR_MAGIC = "biotracker-index";
+			const int SIDECAR_VERSION = 3;
+		}
+
+		std::shared_ptr<VideoIndex> VideoIndex::open(const boost::filesystem::path &video, const std::atomic<bool> *cancel) {
+			if (auto index = load(video)) {
+				return index;
+			}
+
+			auto index = build(video, cancel);
+			if (index && !index->save(video)) {
+				qWarning() << "Could not write video index" << QString::fromStdString(sidecarPath(video).string());
+			}
+			return index;
+		}
+
+		size_t VideoIndex::numFrames() const {
+			return m_numFrames;
+		}
+
+		bool VideoIndex::hasKeyframes() const {
+			return !m_keyframes.empty();
+		}
+
+		size_t VideoIndex::keyframeBefore(size_t frame_number) const {
+			auto it = std::upper_bound(m_keyframes.begin(), m_keyframes.end(), frame_number);
+			if (it == m_keyframes.begin()) {
+				return 0;
+			}
+			return *(--it);
+		}
+
+		bool VideoIndex::hasTimestamps() const {
+			return !m_timestamps.empty();
+		}
+
+		int64_t VideoIndex::timestamp(size_t frame_number) const {
+			return frame_number < m_timestamps.size() ? m_timestamps[frame_number] : -1;
+		}
+
+		boost::filesystem::path VideoIndex::sidecarPath(const boost::filesystem::path &video) {
+			boost::filesystem::path sidecar = video;
+			sidecar += ".btidx";
+			return sidecar;
+		}
+
+		std::shared_ptr<VideoIndex> VideoIndex::load(const boost::filesystem::path &video) {
+			boost::system::error_code ec;
+			const uintmax_t fileSize = boost::filesystem::file_size(video, ec);
+			const std::time_t fileTime = boost::filesystem::last_write_time(video, ec);
+			if (ec) {
+				return nullptr;
+			}
+
+			std::ifstream in(sidecarPath(video).string());
+			if (!in) {
+				return nullptr;
+			}
+
+			std::string magic, key;
+			int version = 0;
+			auto index = std::make_shared<VideoIndex>();
+			size_t numKeyframes = 0;
+			in >> magic >> version;
+			in >> key >> index->m_fileSize;
+			in >> key >> index->m_fileTime;
+			in >> key >> index->m_numFrames;
+			in >> key >> numKeyframes;
+			if (!in || magic != SIDECAR_MAGIC || version != SIDECAR_VERSION
+				|| index->m_fileSize != fileSize || index->m_fileTime != fileTime) {
+				return nullptr;
+			}
+
+			index->m_keyframes.resize(numKeyframes);
+			for (size_t &keyframe : index->m_keyframes) {
+				in >> keyframe;
+			}
+			size_t numTimestamps = 0;
+			in >> key >> numTimestamps;
+			index->m_timestamps.resize(numTimestamps);
+			for (int64_t &timestamp : index->m_timestamps) {
+				in >> timestamp;
+			}
+			// a file cut short or written by a broken build is not trusted
+			size_t endFrames = 0;
+			in >> key >> endFrames;
+			if (!in || key != "end" || endFrames != index->m_numFrames
+				|| (numTimestamps != 0 && numTimestamps != index->m_numFrames)
+				|| std::any_of(index->m_keyframes.begin(), index->m_keyframes.end(), [&index](size_t k) { return k >= index->m_numFrames; })) {
+				return nullptr;
+			}
+			return index;
+		}
+
+		std::shared_ptr<VideoIndex> VideoIndex::build(const boost::filesystem::path &video, const std::atomic<bool> *cancel) {
+			auto index = std::make_shared<VideoIndex>();
+			boost::system::error_code ec;
+			index->m_fileSize = boost::filesystem::file_size(video, ec);
+			index->m_fileTime = boost::filesystem::last_write_time(video, ec);
+			if (ec) {
+				return nullptr;
+			}
+
+#if HAS_LIBAV
+			// Demux only: packet flags tell the keyframes, no frame has to be decoded.
+			AVFormatContext *format = nullptr;
+			if (avformat_open_input(&format, video.string().c_str(), nullptr, nullptr) < 0) {
+				return nullptr;
+			}
+			std::shared_ptr<AVFormatContext> formatGuard(format, [](AVFormatContext *f) { avformat_close_input(&f); });
+			if (avformat_find_stream_info(format, nullptr) < 0) {
+				return nullptr;
+			}
+			const int stream = av_find_best_stream(format, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+			if (stream < 0) {
+				return nullptr;
+			}
+
+			// (presentation timestamp, keyframe) in decode order
+			std::vector<std::pair<int64_t, bool>> packets;
+			AVPacket *packet = av_packet_alloc();
+			while (av_read_frame(format, packet) >= 0) {
+				if (packet->stream_index == stream) {
+					const int64_t ts = packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts;
+					packets.emplace_back(ts, (packet->flags & AV_PKT_FLAG_KEY) != 0);
+				}
+				av_packet_unref(packet);
+				if (cancel && *cancel) {
+					av_packet_free(&packet);
+					return nullptr;
+				}
+			}
+			av_packet_free(&packet);
+
+			// frame numbers are in display order
+			std::stable_sort(packets.begin(), packets.end(),
+				[](const std::pair<int64_t, bool> &a, const std::pair<int64_t, bool> &b) { return a.first < b.first; });
+			index->m_numFrames = packets.size();
+			for (size_t i = 0; i < packets.size(); i++) {
+				if (packets[i].second) {
+					index->m_keyframes.push_back(i);
+				}
+			}
+
+			// timestamps are only known if every packet has one
+			const bool timed = !packets.empty() && std::none_of(packets.begin(), packets.end(),
+				[](const std::pair<int64_t, bool> &p) { return p.first == AV_NOPTS_VALUE; });
+			if (timed) {
+				const AVRational timeBase = format->streams[stream]->time_base;
+				for (const std::pair<int64_t, bool> &p : packets) {
+					index->m_timestamps.push_back(av_rescale_q(p.first - packets.front().first, timeBase, AVRational{ 1, 1000000 }));
+				}
+			}
+#else
+			// Without a demuxer the frames can only be counted.
+			cv::VideoCapture capture(video.string());
+			if (!capture.isOpened()) {
+				return nullptr;
+			}
+			while (capture.grab()) {
+				if (cancel && *cancel) {
+					return nullptr;
+				}
+				index->m_numFrames++;
+			}
+#endif
+			return index;
+		}
+
+		bool VideoIndex::save(const boost::filesystem::path &video) const {
+			// Several builders may index the same video at once (streams, the timeline counter, batch processes):
+			// each writes its own file and moves it over the sidecar, a reader never sees a partly written one
+			const boost::filesystem::path sidecar = sidecarPath(video);
+			boost::system::error_code ec;
+			const boost::filesystem::path temp = boost::filesystem::unique_path(sidecar.string() + ".%%%%%%%%.tmp", ec);
+			if (ec) {
+				return false;
+			}
+			std::ofstream out(temp.string());
+			if (!out) {
+				return false;
+			}
+			out << SIDECAR_MAGIC << " " << SIDECAR_VERSION << "\n";
+			out << "size " << m_fileSize << "\n";
+			out << "mtime " << m_fileTime << "\n";
+			out << "frames " << m_numFrames << "\n";
+			out << "keyframes " << m_keyframes.size() << "\n";
+			for (size_t keyframe : m_keyframes) {
+				out << keyframe << "\n";
+			}
+			out << "timestamps " << m_timestamps.size() << "\n";
+			for (int64_t timestamp : m_timestamps) {
+				out << timestamp << "\n";
+			}
+			out << "end " << m_numFrames << "\n";
+			out.close();
+			if (!out) {
+				boost::filesystem::remove(temp, ec);
+				return false;
+			}
+
+			boost::filesystem::rename(temp, sidecar, ec);
+			if (ec) {
+				boost::filesystem::remove(temp, ec);
+				return false;
+			}
+			return true;
+		}
+
+	}
+}
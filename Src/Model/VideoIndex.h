@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+namespace BioTracker {
+namespace Core {
+
+/**
+ * The VideoIndex holds the exact number of frames of a video and the (display order) numbers of its keyframes.
+ * It is built once by scanning the container and cached in a sidecar file next to the video ("<video>.btidx").
+ * The sidecar is rebuilt if the video's size or modification time changed.
+ *
+ * If BioTracker is built with libav support the container is demuxed without decoding, keyframes and presentation
+ * timestamps are known. Otherwise the frames are only counted via OpenCV and the index holds neither.
+ */
+class VideoIndex {
+public:
+	/**
+	 * Loads the index from the sidecar file or builds (and stores) it if there is no valid sidecar.
+	 * @param cancel the scan is aborted and nullptr is returned as soon as this flag becomes true (may be nullptr)
+	 * @return the index or nullptr if the video could not be scanned
+	 */
+	static std::shared_ptr<VideoIndex> open(const boost::filesystem::path &video, const std::atomic<bool> *cancel = nullptr);
+
+	/**
+	 * @return the exact number of frames
+	 */
+	size_t numFrames() const;
+
+	/**
+	 * @return true, if keyframe positions are known
+	 */
+	bool hasKeyframes() const;
+
+	/**
+	 * @return the number of the last keyframe at or before frame_number, 0 if it is unknown
+	 */
+	size_t keyframeBefore(size_t frame_number) const;
+
+	/**
+	 * @return true, if the presentation timestamps of the frames are known
+	 */
+	bool hasTimestamps() const;
+
+	/**
+	 * @return the presentation timestamp of the frame in microseconds since the first frame, -1 if it is unknown
+	 */
+	int64_t timestamp(size_t frame_number) const;
+
+	/**
+	 * @return the path of the sidecar file belonging to the given video
+	 */
+	static boost::filesystem::path sidecarPath(const boost::filesystem::path &video);
+
+private:
+	static std::shared_ptr<VideoIndex> load(const boost::filesystem::path &video);
+	static std::shared_ptr<VideoIndex> build(const boost::filesystem::path &video, const std::atomic<bool> *cancel);
+	bool save(const boost::filesystem::path &video) const;
+
+	size_t m_numFrames = 0;
+	std::vector<size_t> m_keyframes;
+	std::vector<int64_t> m_timestamps;
+	uintmax_t m_fileSize = 0;
+	std::time_t m_fileTime = 0;
+};
+
+}
+}
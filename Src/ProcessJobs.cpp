@@ -0,0 +1,149 @@
+#include "ProcessJobs.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QRegularExpression>
+
+#include <iostream>
+#include <string>
+
+ProcessJobs::ProcessJobs(QObject *parent) :
+	QObject(parent),
+	m_Running(0),
+	m_Done(0) {
+}
+
+size_t ProcessJobs::add(const QString &name, const QString &exportPath, const QString &logPath) {
+	Job job;
+	job.name = name;
+	job.exportPath = exportPath;
+	job.logPath = logPath;
+	m_Jobs.push_back(job);
+	return m_Jobs.size() - 1;
+}
+
+bool ProcessJobs::launch(size_t index, const QStringList &arguments) {
+	Job &job = m_Jobs[index];
+
+	QFile::remove(job.logPath);
+	job.process = new QProcess(this);
+	job.process->setProcessChannelMode(QProcess::MergedChannels);
+	QObject::connect(job.process, &QProcess::readyReadStandardOutput, this, [this, index]() {
+		readOutput(index);
+	});
+	QObject::connect(job.process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this,
+		[this, index](int exitCode, QProcess::ExitStatus status) {
+		finish(index, exitCode, status);
+	});
+
+	job.state = Job::State::Running;
+	job.begin = std::chrono::steady_clock::now();
+	m_Running++;
+	job.process->start(QCoreApplication::applicationFilePath(), arguments);
+	if (!job.process->waitForStarted()) {
+		finish(index, -1, QProcess::CrashExit);
+		return false;
+	}
+	job.pid = job.process->processId();
+	return true;
+}
+
+void ProcessJobs::fail(size_t index) {
+	Job &job = m_Jobs[index];
+	if (job.state != Job::State::Pending)
+		return;
+
+	job.state = Job::State::Failed;
+	job.exitCode = -1;
+	m_Done++;
+}
+
+size_t ProcessJobs::failed() const {
+	size_t failed = 0;
+	for (const Job &job : m_Jobs) {
+		failed += job.state == Job::State::Failed;
+	}
+	return failed;
+}
+
+size_t ProcessJobs::frames() const {
+	size_t frames = 0;
+	for (const Job &job : m_Jobs) {
+		frames += job.frames;
+	}
+	return frames;
+}
+
+void ProcessJobs::readOutput(size_t index, bool flush) {
+	Job &job = m_Jobs[index];
+	const QByteArray output = job.process->readAllStandardOutput();
+
+	QFile log(job.logPath);
+	if (log.open(QIODevice::WriteOnly | QIODevice::Append)) {
+		log.write(output);
+	}
+
+	job.partialLine += output;
+	int end;
+	while ((end = job.partialLine.indexOf('\n')) >= 0) {
+		readLine(job, QString::fromLocal8Bit(job.partialLine.left(end)));
+		job.partialLine.remove(0, end + 1);
+	}
+	if (flush && !job.partialLine.isEmpty()) {
+		readLine(job, QString::fromLocal8Bit(job.partialLine));
+		job.partialLine.clear();
+	}
+}
+
+void ProcessJobs::readLine(Job &job, const QString &line) {
+	static const QRegularExpression tracked("Tracked (\\d+) frames");
+	static const QRegularExpression exported("Exported file: (.*)$");
+
+	QRegularExpressionMatch match = tracked.match(line);
+	if (match.hasMatch()) {
+		job.frames = match.captured(1).toULongLong();
+	}
+	match = exported.match(line.trimmed());
+	if (match.hasMatch()) {
+		job.exportedFile = match.captured(1);
+	}
+}
+
+void ProcessJobs::finish(size_t index, int exitCode, QProcess::ExitStatus status) {
+	Job &job = m_Jobs[index];
+	if (job.state != Job::State::Running)
+		return;
+
+	readOutput(index, true);
+	job.end = std::chrono::steady_clock::now();
+	job.exitCode = exitCode;
+	job.state = (status == QProcess::NormalExit && exitCode == 0) ? Job::State::Succeeded : Job::State::Failed;
+	job.process->deleteLater();
+	job.process = nullptr;
+	m_Running--;
+	m_Done++;
+
+	const double seconds = std::chrono::duration<double>(job.end - job.begin).count();
+	std::cout << "[" << m_Done << "/" << m_Jobs.size() << "] "
+		<< (job.state == Job::State::Succeeded ? "OK     " : "FAILED ") << job.name.toStdString()
+		<< " (" << job.frames << " frames, " << seconds << " s";
+	if (job.state == Job::State::Failed) {
+		std::cout << ", " << (status == QProcess::CrashExit ? std::string("crashed") : "exit code " + std::to_string(exitCode))
+			<< ", see " << job.logPath.toStdString();
+	}
+	std::cout << ")" << std::endl;
+
+	Q_EMIT jobFinished(index);
+}
+
+void ProcessJobs::printResults() const {
+	for (const Job &job : m_Jobs) {
+		if (job.state == Job::State::Succeeded) {
+			std::cout << "OK     " << job.name.toStdString() << " -> "
+				<< (job.exportedFile.isEmpty() ? job.exportPath : job.exportedFile).toStdString() << std::endl;
+		}
+		else {
+			std::cout << "FAILED " << job.name.toStdString() << " (exit code " << job.exitCode << ", see " << job.logPath.toStdString() << ")" << std::endl;
+		}
+	}
+}
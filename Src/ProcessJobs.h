@@ -0,0 +1,103 @@
+#ifndef PROCESSJOBS_H
+#define PROCESSJOBS_H
+
+#include <QObject>
+#include <QProcess>
+#include <QStringList>
+
+#include <chrono>
+#include <vector>
+
+/**
+ * The ProcessJobs run BioTracker processes in headless mode for the BatchRunner and the SweepRunner.
+ * The output of every job goes to its log file, the frames tracked and the file exported are picked up from it.
+ * Finished jobs are reported on stdout, the runners decide what runs next.
+ */
+class ProcessJobs : public QObject {
+	Q_OBJECT
+public:
+	struct Job {
+		enum class State { Pending, Running, Succeeded, Failed };
+
+		// The video or parameter set tracked, as reported
+		QString name;
+		QString exportPath;
+		QString logPath;
+		QString exportedFile;
+		QProcess *process = nullptr;
+		// Output after the last complete line, a line may arrive in several reads
+		QByteArray partialLine;
+		qint64 pid = 0;
+		State state = State::Pending;
+		int exitCode = 0;
+		size_t frames = 0;
+		std::chrono::steady_clock::time_point begin;
+		std::chrono::steady_clock::time_point end;
+	};
+
+	explicit ProcessJobs(QObject *parent = 0);
+
+	/**
+	 * Adds a pending job.
+	 * @return the index of the job
+	 */
+	size_t add(const QString &name, const QString &exportPath, const QString &logPath);
+
+	/**
+	 * Starts the job index as a BioTracker process with arguments.
+	 * @return false if the process could not be started, the job has failed then
+	 */
+	bool launch(size_t index, const QStringList &arguments);
+
+	/**
+	 * Gives up a pending job without running it.
+	 */
+	void fail(size_t index);
+
+	const Job &job(size_t index) const {
+		return m_Jobs[index];
+	}
+	const std::vector<Job> &jobs() const {
+		return m_Jobs;
+	}
+	size_t size() const {
+		return m_Jobs.size();
+	}
+	size_t running() const {
+		return m_Running;
+	}
+	size_t done() const {
+		return m_Done;
+	}
+	size_t failed() const;
+	/**
+	 * @return the frames tracked by all jobs so far
+	 */
+	size_t frames() const;
+
+	/**
+	 * Prints one line per job: the export of a succeeded job, the log of a failed one.
+	 */
+	void printResults() const;
+
+Q_SIGNALS:
+	/**
+	 * The job index finished (or could not be started), it is reported already.
+	 */
+	void jobFinished(size_t index);
+
+private:
+	/**
+	 * Logs the new output of the job index and picks the frames tracked and the file exported up from its complete lines.
+	 * @param flush also reads the last line if it is not terminated, once the process finished
+	 */
+	void readOutput(size_t index, bool flush = false);
+	void readLine(Job &job, const QString &line);
+	void finish(size_t index, int exitCode, QProcess::ExitStatus status);
+
+	std::vector<Job> m_Jobs;
+	size_t m_Running;
+	size_t m_Done;
+};
+
+#endif // PROCESSJOBS_H
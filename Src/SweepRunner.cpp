@@ -0,0 +1,301 @@
+#include "SweepRunner.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QThread>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+SweepRunner::SweepRunner(QObject *parent, Config *cfg) :
+	QObject(parent),
+	_cfg(cfg),
+	m_DecodeCfg(*cfg),
+	m_Next(0),
+	m_MaxJobs(1),
+	m_Round(0),
+	m_FirstFrame(false),
+	m_Decoded(0) {
+
+	m_DecodeCfg.FrameStride = 1;
+	QObject::connect(&m_Jobs, &ProcessJobs::jobFinished, this, &SweepRunner::jobFinished);
+	QObject::connect(&m_ProgressTimer, &QTimer::timeout, this, &SweepRunner::printProgress);
+}
+
+QStringList SweepRunner::expandSweep(const QString &spec) {
+	QFileInfo fi(spec);
+	if (fi.suffix() == "txt" || fi.suffix() == "lst") {
+		QFile file(spec);
+		if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+			throw std::invalid_argument("Could not read " + spec.toStdString());
+		}
+		QStringList sets;
+		QTextStream ts(&file);
+		while (!ts.atEnd()) {
+			const QString line = ts.readLine().trimmed();
+			if (line.isEmpty() || line.startsWith('#'))
+				continue;
+			sets << line;
+		}
+		return sets;
+	}
+
+	QStringList sets;
+	for (const QString &entry : spec.split(',', QString::SkipEmptyParts)) {
+		const int separator = entry.indexOf('=');
+		if (separator <= 0) {
+			throw std::invalid_argument("Invalid sweep parameter " + entry.toStdString() + ", use key=values");
+		}
+		const QString key = entry.left(separator).trimmed();
+		const QString values = entry.mid(separator + 1).trimmed();
+
+		QStringList alternatives;
+		const QStringList range = values.split(':');
+		if (range.size() == 3) {
+			bool ok[3];
+			const double start = range[0].toDouble(&ok[0]);
+			const double stop = range[1].toDouble(&ok[1]);
+			const double step = range[2].toDouble(&ok[2]);
+			if (!ok[0] || !ok[1] || !ok[2] || step <= 0 || stop < start) {
+				throw std::invalid_argument("Invalid range " + values.toStdString() + " of " + key.toStdString() + ", use start:stop:step");
+			}
+			// Counted rather than summed up, so the rounding errors do not add up
+			const int count = static_cast<int>(std::floor((stop - start) / step + 1e-9)) + 1;
+			for (int i = 0; i < count; i++) {
+				alternatives << QString::number(start + i * step);
+			}
+		}
+		else {
+			for (const QString &value : values.split('|', QString::SkipEmptyParts)) {
+				alternatives << value.trimmed();
+			}
+		}
+		if (alternatives.isEmpty()) {
+			throw std::invalid_argument("No values for sweep parameter " + key.toStdString());
+		}
+
+		QStringList combined;
+		for (const QString &value : alternatives) {
+			if (sets.isEmpty()) {
+				combined << key + "=" + value;
+			}
+			for (const QString &set : sets) {
+				combined << set + "," + key + "=" + value;
+			}
+		}
+		sets = combined;
+	}
+	return sets;
+}
+
+bool SweepRunner::start(const QString &spec) {
+	if (_cfg->UsePlugins.isEmpty()) {
+		std::cout << "--sweep needs a plugin, use --usePlugin" << std::endl;
+		return false;
+	}
+	if (_cfg->LoadVideo.isEmpty()) {
+		std::cout << "--sweep needs a video, use --video" << std::endl;
+		return false;
+	}
+
+	QStringList sets;
+	try {
+		sets = expandSweep(spec);
+	}
+	catch (const std::invalid_argument &e) {
+		std::cout << e.what() << std::endl;
+		return false;
+	}
+	if (sets.isEmpty()) {
+		std::cout << "No parameter sets to track" << std::endl;
+		return false;
+	}
+
+	QDir exportDir(_cfg->ExportPath.isEmpty() ? _cfg->DirTracks : _cfg->ExportPath);
+	exportDir.mkpath(".");
+	m_ExportDir = exportDir.absolutePath();
+	m_Name = QFileInfo(_cfg->LoadVideo).completeBaseName();
+
+	for (int i = 0; i < sets.size(); i++) {
+		const QString name = m_Name + "_sweep" + QString::number(i + 1);
+		m_Jobs.add(sets[i], exportDir.absoluteFilePath(name), exportDir.absoluteFilePath(name + ".log"));
+	}
+
+	// The instances share one decoding thread, every instance runs a tracking thread
+	m_MaxJobs = _cfg->BatchJobs > 0 ? _cfg->BatchJobs : std::max(1, QThread::idealThreadCount() - 1);
+	m_MaxJobs = std::min(m_MaxJobs, static_cast<int>(BioTracker::Core::SHARED_RING_MAX_CONSUMERS));
+	std::cout << "Sweeping " << m_Jobs.size() << " parameter sets over " << _cfg->LoadVideo.toStdString() << ", "
+		<< m_MaxJobs << " at once, exports in " << m_ExportDir.toStdString() << std::endl;
+
+	m_Begin = std::chrono::steady_clock::now();
+	if (!startRound())
+		return false;
+	m_ProgressTimer.start(10000);
+	return true;
+}
+
+bool SweepRunner::startRound() {
+	m_Stream = BioTracker::Core::make_ImageStream3Files(&m_DecodeCfg, { _cfg->LoadVideo.toStdString() });
+	if (m_Stream->type() == GuiParam::MediaType::NoMedia || m_Stream->currentFrameIsEmpty()) {
+		std::cout << "Could not open " << _cfg->LoadVideo.toStdString() << std::endl;
+		m_Stream.reset();
+		return false;
+	}
+
+	const size_t count = std::min(m_Jobs.size() - m_Next, static_cast<size_t>(m_MaxJobs));
+	const cv::Mat &frame = *m_Stream->currentFrame();
+	const std::string name = "biotracker_sweep_" + std::to_string(QCoreApplication::applicationPid()) + "_" + std::to_string(m_Round++);
+	try {
+		// The instances copy every frame out right away, a few slots cover the decoding ahead
+		m_Ring = BioTracker::Core::SharedFrameRing::create(name, static_cast<uint32_t>(std::max(_cfg->CaptureRingFrames, 2)),
+			frame.total() * frame.elemSize(), static_cast<uint32_t>(count));
+	}
+	catch (const std::runtime_error &e) {
+		std::cout << e.what() << std::endl;
+		m_Stream.reset();
+		return false;
+	}
+	m_FirstFrame = true;
+
+	for (size_t i = 0; i < count; i++) {
+		const size_t index = m_Next++;
+		const ProcessJobs::Job &job = m_Jobs.job(index);
+
+		QStringList arguments{ "--headless", "--usePlugin", _cfg->UsePlugins, "--shm", QString::fromStdString(name),
+			"--export", job.exportPath, "--pluginParameters", job.name };
+		if (!_cfg->CfgCustomLocation.isEmpty()) {
+			arguments << "--cfg" << _cfg->CfgCustomLocation;
+		}
+		m_Jobs.launch(index, arguments);
+	}
+
+	QTimer::singleShot(0, this, &SweepRunner::publish);
+	return true;
+}
+
+void SweepRunner::publish() {
+	if (!m_Ring || !m_Stream)
+		return;
+
+	// Returns to the event loop regularly to collect the output of the instances
+	const auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(50);
+	while (std::chrono::steady_clock::now() < until) {
+		if (!m_Ring->waitForSpace(std::chrono::milliseconds(10)))
+			break;
+
+		// A freshly opened stream already holds its first frame
+		if (!m_FirstFrame && !m_Stream->nextFrame()) {
+			endOfStream();
+			return;
+		}
+		m_FirstFrame = false;
+
+		std::shared_ptr<cv::Mat> frame = m_Stream->currentFrame();
+		if (!frame || frame->empty()) {
+			endOfStream();
+			return;
+		}
+		// The capture time travels with the frame, so the instances trace the latency from the decode on
+		const BioTracker::Core::FrameDescriptor descriptor = m_Stream->currentDescriptor();
+		const int64_t captured = std::chrono::duration_cast<std::chrono::microseconds>(
+			descriptor.stamps[BioTracker::Core::FrameDescriptor::Captured].time_since_epoch()).count();
+		if (!m_Ring->publish(*frame, captured)) {
+			std::cout << "Frame " << m_Stream->currentFrameNumber() << " is larger than the first frame, the sweep ends here" << std::endl;
+			endOfStream();
+			return;
+		}
+		m_Decoded++;
+	}
+	QTimer::singleShot(0, this, &SweepRunner::publish);
+}
+
+void SweepRunner::endOfStream() {
+	// The instances track the frames still in the ring, the ring stays until they are done
+	m_Ring->close();
+	m_Stream.reset();
+}
+
+void SweepRunner::jobFinished(size_t index) {
+	// The decoding must not wait for an instance that is gone
+	if (m_Ring) {
+		m_Ring->detachConsumer(m_Jobs.job(index).pid);
+	}
+
+	if (m_Jobs.running() == 0) {
+		QTimer::singleShot(0, this, &SweepRunner::nextRound);
+	}
+}
+
+void SweepRunner::nextRound() {
+	if (m_Jobs.running() > 0)
+		return;
+
+	m_Ring.reset();
+	m_Stream.reset();
+	if (m_Next < m_Jobs.size() && !startRound()) {
+		for (size_t i = m_Next; i < m_Jobs.size(); i++) {
+			m_Jobs.fail(i);
+		}
+		m_Next = m_Jobs.size();
+	}
+
+	if (m_Jobs.done() == m_Jobs.size()) {
+		m_ProgressTimer.stop();
+		writeIndex();
+		printSummary();
+	}
+}
+
+void SweepRunner::printProgress() {
+	size_t slowest = 0;
+	size_t fastest = 0;
+	bool running = false;
+	for (const ProcessJobs::Job &job : m_Jobs.jobs()) {
+		if (job.state == ProcessJobs::Job::State::Running) {
+			slowest = running ? std::min(slowest, job.frames) : job.frames;
+			fastest = std::max(fastest, job.frames);
+			running = true;
+		}
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_Begin).count();
+	std::cout << "Sweep: " << m_Jobs.done() << "/" << m_Jobs.size() << " done (" << m_Jobs.failed() << " failed), " << m_Jobs.running() << " running, "
+		<< m_Decoded << " frames decoded (" << (seconds > 0 ? m_Decoded / seconds : 0) << " fps), "
+		<< slowest << "-" << fastest << " tracked per instance" << std::endl;
+}
+
+void SweepRunner::writeIndex() {
+	const QString path = QDir(m_ExportDir).absoluteFilePath(m_Name + "_sweep.csv");
+	QFile file(path);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+		std::cout << "Could not write " << path.toStdString() << std::endl;
+		return;
+	}
+
+	// The parameter sets contain commas, they are quoted
+	const QString sep = _cfg->CsvSeperator;
+	QTextStream ts(&file);
+	ts << "set" << sep << "parameters" << sep << "frames" << sep << "status" << sep << "export" << "\n";
+	for (size_t i = 0; i < m_Jobs.size(); i++) {
+		const ProcessJobs::Job &job = m_Jobs.job(i);
+		ts << i + 1 << sep << "\"" << job.name << "\"" << sep << job.frames << sep
+			<< (job.state == ProcessJobs::Job::State::Succeeded ? "OK" : "FAILED") << sep
+			<< (job.exportedFile.isEmpty() ? job.exportPath : job.exportedFile) << "\n";
+	}
+	std::cout << "Sweep index: " << path.toStdString() << std::endl;
+}
+
+void SweepRunner::printSummary() {
+	const size_t failed = m_Jobs.failed();
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_Begin).count();
+
+	std::cout << std::endl << "Sweep finished: " << m_Jobs.size() - failed << " of " << m_Jobs.size() << " parameter sets tracked, "
+		<< m_Decoded << " frames decoded in " << m_Round << (m_Round == 1 ? " round, " : " rounds, ") << seconds << " s" << std::endl;
+	m_Jobs.printResults();
+
+	Q_EMIT finished(failed ? 1 : 0);
+}
@@ -0,0 +1,85 @@
+#ifndef SWEEPRUNNER_H
+#define SWEEPRUNNER_H
+
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+
+#include "ProcessJobs.h"
+#include "Model/ImageStream.h"
+#include "Model/SharedFrameRing.h"
+#include "util/Config.h"
+
+#include <chrono>
+#include <memory>
+
+/**
+ * The SweepRunner tracks one video once per plugin parameter set, e.g. to tune a tracker. The video is decoded once:
+ * every frame is published into a lossless SharedFrameRing and read by all plugin instances, which run in their own
+ * BioTracker processes in headless mode (plugins are singletons within a process) and write their own exports.
+ * BatchJobs instances run at once, a larger sweep decodes the video once per round of instances.
+ */
+class SweepRunner : public QObject {
+	Q_OBJECT
+public:
+	SweepRunner(QObject *parent = 0, Config *cfg = nullptr);
+
+	/**
+	 * Expands the parameter sets given by spec and starts the first round of plugin instances on the video given by LoadVideo.
+	 * @return false if there is no parameter set, no plugin or no video
+	 */
+	bool start(const QString &spec);
+
+	/**
+	 * Expands a grid of parameters to one parameter set ("key=value,...") per combination. Values are alternatives
+	 * separated by | or an inclusive range start:stop:step, e.g. "threshold=10:40:10,minArea=20|50".
+	 * A text file (*.txt, *.lst) lists one parameter set per line instead.
+	 * @throw std::invalid_argument on a malformed grid
+	 */
+	static QStringList expandSweep(const QString &spec);
+
+Q_SIGNALS:
+	/**
+	 * All parameter sets are tracked, exitCode is 0 if every instance succeeded.
+	 */
+	void finished(int exitCode);
+
+private Q_SLOTS:
+	/**
+	 * Decodes frames into the ring as long as the instances keep up.
+	 */
+	void publish();
+	/**
+	 * Starts the next round of instances once all instances of a round are done.
+	 */
+	void nextRound();
+	void printProgress();
+
+private:
+	bool startRound();
+	void endOfStream();
+	void jobFinished(size_t index);
+	void writeIndex();
+	void printSummary();
+
+	Config *_cfg;
+	// The video is decoded without the frame stride, the instances apply it
+	Config m_DecodeCfg;
+	// One job per parameter set
+	ProcessJobs m_Jobs;
+	QString m_ExportDir;
+	QString m_Name;
+	size_t m_Next;
+	int m_MaxJobs;
+	int m_Round;
+
+	std::shared_ptr<BioTracker::Core::ImageStream> m_Stream;
+	std::shared_ptr<BioTracker::Core::SharedFrameRing> m_Ring;
+	bool m_FirstFrame;
+	size_t m_Decoded;
+
+	QTimer m_ProgressTimer;
+	std::chrono::steady_clock::time_point m_Begin;
+};
+
+#endif // SWEEPRUNNER_H
@@ -0,0 +1,140 @@
+/****************************************************************************
+  **
+  ** Reference producer for the shared memory frame source (see Model/SharedFrameRing.h).
+  ** Publishes the frames of a video or of a synthetic scene into a frame ring, paced at a given frame rate:
+  **
+  **   BioTrackerShmProducer --name biotracker --video fish.mp4 --fps 30
+  **   BioTracker --shm biotracker
+  **
+  ****************************************************************************/
+
+#include "Model/SharedFrameRing.h"
+#include "Model/SyntheticScene.h"
+
+#include <boost/program_options.hpp>
+#include <opencv2/opencv.hpp>
+
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <thread>
+
+namespace {
+	volatile std::sig_atomic_t stop = 0;
+
+	void requestStop(int) {
+		stop = 1;
+	}
+}
+
+int main(int argc, char* argv[]) {
+	using namespace boost::program_options;
+	using namespace BioTracker::Core;
+
+	options_description options("Allowed options");
+	options.add_options()
+		("help", "Produce this help message")
+		("name", value<std::string>()->default_value("biotracker"), "Name of the shared memory segment")
+		("video", value<std::string>(), "Publishes the frames of the given video")
+		("synthetic", value<std::string>()->default_value("width=1280,height=720,count=10"), "Publishes a synthetic scene, see BioTracker --synthetic")
+		("slots", value<uint32_t>()->default_value(8), "Number of frames held in the ring")
+		("fps", value<double>()->default_value(30), "Publishing rate, 0 publishes as fast as possible")
+		("loop", "Starts over at the end of the video")
+		("gray", "Publishes single channel frames")
+		;
+
+	variables_map vm;
+	try {
+		store(parse_command_line(argc, argv, options), vm);
+	}
+	catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+	if (vm.count("help")) {
+		std::cout << options;
+		return 0;
+	}
+
+	cv::VideoCapture capture;
+	std::unique_ptr<SyntheticScene> scene;
+	if (vm.count("video")) {
+		capture.open(vm["video"].as<std::string>());
+		if (!capture.isOpened()) {
+			std::cerr << "Could not open video " << vm["video"].as<std::string>() << std::endl;
+			return 1;
+		}
+	}
+	else {
+		try {
+			scene.reset(new SyntheticScene(SyntheticConfiguration::parse(vm["synthetic"].as<std::string>())));
+		}
+		catch (const std::exception &e) {
+			std::cerr << e.what() << std::endl;
+			return 1;
+		}
+	}
+
+	const bool gray = vm.count("gray") > 0;
+	size_t frameNumber = 0;
+	cv::Mat source;
+	if (scene) {
+		source.create(scene->configuration().height, scene->configuration().width, CV_8UC3);
+	}
+	auto next = [&](cv::Mat &frame) {
+		if (scene) {
+			scene->render(frameNumber % std::max<size_t>(scene->configuration().frames, 1), source);
+		}
+		else if (!capture.read(source) && vm.count("loop")) {
+			capture.set(cv::CAP_PROP_POS_FRAMES, 0);
+			capture.read(source);
+		}
+		if (source.empty()) {
+			return false;
+		}
+		if (gray && source.channels() == 3) {
+			cv::cvtColor(source, frame, cv::COLOR_BGR2GRAY);
+		}
+		else {
+			frame = source;
+		}
+		frameNumber++;
+		return true;
+	};
+
+	// the slots are sized by the first frame
+	cv::Mat frame;
+	if (!next(frame)) {
+		std::cerr << "No frames" << std::endl;
+		return 1;
+	}
+
+	std::shared_ptr<SharedFrameRing> ring;
+	try {
+		ring = SharedFrameRing::create(vm["name"].as<std::string>(), vm["slots"].as<uint32_t>(), frame.total() * frame.elemSize());
+	}
+	catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	std::signal(SIGINT, requestStop);
+	std::signal(SIGTERM, requestStop);
+
+	const double fps = vm["fps"].as<double>();
+	const auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(fps > 0 ? 1.0 / fps : 0.0));
+	auto due = std::chrono::steady_clock::now();
+	std::cout << "Publishing " << frame.cols << "x" << frame.rows << " frames to " << vm["name"].as<std::string>() << std::endl;
+
+	do {
+		const int64_t timestamp = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		if (!ring->publish(frame, timestamp)) {
+			std::cerr << "Frame " << frameNumber << " does not fit into a slot" << std::endl;
+		}
+		due += interval;
+		std::this_thread::sleep_until(due);
+	} while (!stop && next(frame));
+
+	std::cout << "Published " << ring->published() << " frames" << std::endl;
+	return 0;
+}
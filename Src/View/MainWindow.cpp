@@ -770,7 +770,7 @@ void MainWindow::on_actionDelete_selected_Annotation_triggered() {
 ///////////////////////////////menu->file slots/////////////////////////////
 
 void MainWindow::on_actionOpen_Video_triggered() {
-	static const QString videoFilter("Video files (*.avi *.wmv *.mp4 *.mkv *.mov)");
+	static const QString videoFilter("Video files (*.avi *.wmv *.mp4 *.mkv *.mov *.btraw)");
 
 	QString filename = QFileDialog::getOpenFileName(this,
 		"Open video", "", videoFilter, 0);
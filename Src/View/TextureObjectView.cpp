@@ -3,6 +3,8 @@
 #include "QGraphicsScene"
 #include "View/GraphicsView.h"
 
+#include <algorithm>
+
 
 TextureObjectView::TextureObjectView(QObject *parent, IController *controller, IModel *model) :
     IViewGraphicsPixmapItem(parent, controller, model)
@@ -18,11 +20,16 @@ void TextureObjectView::getNotified()
     pma.convertFromImage(texture->get());
     setPixmap(pma);
 
+    // previews are smaller than the frame: scale them up, so scene coordinates stay frame pixels for all overlays
+    const QSize source = texture->sourceSize();
+    setTransform(QTransform::fromScale(static_cast<qreal>(source.width()) / std::max(texture->width(), 1),
+                                       static_cast<qreal>(source.height()) / std::max(texture->height(), 1)));
+
 	//if frame is set, set the boundingrect of the scene to the size of the frame
 	if (texture->height() > 1) {
 		QGraphicsScene *scene = this->scene();
 
-		QRectF currentBoundingRect = this->boundingRect();
+		QRectF currentBoundingRect = this->sceneBoundingRect();
 
 		//check if bounding rect changed -> this means that a new video has been loaded, right?
 		if (currentBoundingRect != _oldBoundingRect) {
@@ -1,6 +1,9 @@
 #include <QApplication>
 #include "BioTracker3App.h"
 #include "GuiContext.h"
+#include "HeadlessRunner.h"
+#include "BatchRunner.h"
+#include "SweepRunner.h"
 #include "opencv2/core/core.hpp"
 #include <boost/filesystem.hpp>
 #include <QVector>
@@ -14,6 +17,10 @@
 #include "util/CLIcommands.h"
 #include "Interfaces/IModel/IModelTrackedComponent.h"
 #include "util/Config.h"
+#include "Model/LatencyTracer.h"
+#include "Model/RawFrameFile.h"
+#include "Model/SyntheticScene.h"
+#include "Model/VideoBenchmark.h"
 #include <QDir>
 
 //This will hide the console. 
@@ -42,6 +49,11 @@ void myMessageOutput(QtMsgType type, const QMessageLogContext &context, const QS
 }
 
 int main(int argc, char* argv[]) {
+    // Plugins still create their widgets in headless mode, they must not need a display
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--headless" || std::string(argv[i]) == "--batch" || std::string(argv[i]) == "--sweep")
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
     QApplication app(argc, argv);
     
     app.setOrganizationName("FU Berlin");
@@ -52,17 +64,42 @@ int main(int argc, char* argv[]) {
 	CLI::optionParser(argc, argv, cfg);
     QString cfgLoc = cfg->CfgCustomLocation.isEmpty()?Config::configLocation:cfg->CfgCustomLocation;
     cfg->load(cfgLoc, "config.ini");
-    cfg->save(cfgLoc, "config.ini");
+    // Batch jobs run in parallel and must not write the config at the same time
+    if (!cfg->Headless)
+        cfg->save(cfgLoc, "config.ini");
+
+    if (!cfg->ConvertRaw.isEmpty()) {
+        try {
+            uint64_t frames = BioTracker::Core::convertVideoToRawFrameFile(cfg->LoadVideo.toStdString(), cfg->ConvertRaw.toStdString());
+            std::cout << "Wrote " << frames << " frames to " << cfg->ConvertRaw.toStdString() << std::endl;
+            return 0;
+        }
+        catch (const std::exception &e) {
+            std::cout << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    if (!cfg->BenchmarkDecode.isEmpty()) {
+        BioTracker::Core::benchmarkVideoBackends(cfg, cfg->BenchmarkDecode.toStdString(), 1000, std::cout);
+        return 0;
+    }
+
+    if (!cfg->LatencyTrace.isEmpty() && !BioTracker::Core::LatencyTracer::instance().open(cfg->LatencyTrace.toStdString(), cfg->CsvSeperator.toStdString())) {
+        std::cout << "Could not open latency trace " << cfg->LatencyTrace.toStdString() << std::endl;
+    }
 
     qRegisterMetaType<cv::Mat>("cv::Mat");
     qRegisterMetaType<std::shared_ptr<cv::Mat>>("std::shared_ptr<cv::Mat>");
     qRegisterMetaType<std::size_t>("std::size_t");
     qRegisterMetaType<size_t>("size_t");
     qRegisterMetaType<std::vector<boost::filesystem::path>>("std::vector<boost::filesystem::path>");
+    qRegisterMetaType<boost::filesystem::path>("boost::filesystem::path");
     qRegisterMetaType<BiotrackerTypes::AreaType>("BiotrackerTypes::AreaType");
     qRegisterMetaType<QVector<bool>>("QVector<bool>");
     qRegisterMetaType<playerParameters*>("playerParameters*");
 	qRegisterMetaType<CameraConfiguration>("CameraConfiguration");
+	qRegisterMetaType<BioTracker::Core::SyntheticConfiguration>("BioTracker::Core::SyntheticConfiguration");
     qRegisterMetaTypeStreamOperators<QList<IModelTrackedComponent*>>("QList<IModelTrackedComponent*>");
     
     qInstallMessageHandler(myMessageOutput);
@@ -77,6 +114,30 @@ int main(int argc, char* argv[]) {
     qd.mkpath(cfg->DirScreenshots);
     qd.mkpath(cfg->DirTemp);
 
+    if (!cfg->SweepSpec.isEmpty()) {
+        SweepRunner runner(&app, cfg);
+        QObject::connect(&runner, &SweepRunner::finished, &app, &QCoreApplication::exit, Qt::QueuedConnection);
+        if (!runner.start(cfg->SweepSpec))
+            return 1;
+        return app.exec();
+    }
+
+    if (!cfg->BatchInputs.isEmpty()) {
+        BatchRunner runner(&app, cfg);
+        QObject::connect(&runner, &BatchRunner::finished, &app, &QCoreApplication::exit, Qt::QueuedConnection);
+        if (!runner.start(cfg->BatchInputs))
+            return 1;
+        return app.exec();
+    }
+
+    if (cfg->Headless) {
+        HeadlessRunner runner(&app, cfg);
+        QObject::connect(&runner, &HeadlessRunner::finished, &app, &QCoreApplication::exit, Qt::QueuedConnection);
+        if (!runner.start())
+            return 1;
+        return app.exec();
+    }
+
     BioTracker3App bioTracker3(&app);
     GuiContext context(&bioTracker3, cfg);
     bioTracker3.setBioTrackerContext(&context);
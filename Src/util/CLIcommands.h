@@ -11,6 +11,8 @@
 #include <iostream>
 #include <fstream>
 #include <exception>
+#include <string>
+#include <vector>
 
 #include <qfile.h>
 #include <qfileinfo.h>
@@ -32,6 +34,22 @@ public:
 				("usePlugin", value<std::string>(), "Uses plugin from given filepath")
 				("video", value<std::string>(), "Loads a video from given filepath")
 				("cfg", value<std::string>(), "Provide custom path to a config file")
+				("watch", value<std::string>(), "Watches the given directory and tracks the images written into it live")
+				("pipe", value<std::string>(), "Reads raw frames from the given named pipe, \"-\" reads from stdin (e.g. ffmpeg -f rawvideo -pix_fmt bgr24 - | BioTracker --pipe - ...)")
+				("pipeWidth", value<int>(), "Width of the frames read with --pipe")
+				("pipeHeight", value<int>(), "Height of the frames read with --pipe")
+				("pipeFormat", value<std::string>(), "Pixel format of the frames read with --pipe: bgr24 (default), rgb24 or gray")
+				("shm", value<std::string>(), "Attaches to the shared memory frame ring of the given name, e.g. one filled by BioTrackerShmProducer")
+				("synthetic", value<std::string>(), "Loads a synthetic scene, e.g. \"width=1920,height=1080,count=20,shape=ellipse,noise=5,seed=1,groundtruth=gt.csv\"")
+				("latencyTrace", value<std::string>(), "Writes the per-stage latency of every frame (decode, tracker handoff, tracking, render, export) as CSV to the given filepath")
+				("benchmarkDecode", value<std::string>(), "Decodes the given video with every available video backend, prints the throughput and exits")
+				("convertRaw", value<std::string>(), "Converts the video given by --video to a raw frame file (*.btraw) at the given filepath and exits")
+				("headless", "Tracks the source (--video, --pipe, --shm, --watch or --synthetic) with the plugin given by --usePlugin without GUI, writes the export and exits")
+				("export", value<std::string>(), "Filepath of the export written in --headless mode, default: a new file in the tracks directory. With --batch and --sweep the directory the exports are written to")
+				("batch", value<std::vector<std::string>>()->multitoken()->composing(), "Tracks many videos with the plugin given by --usePlugin in parallel headless processes and exits. Takes video files, globs (e.g. \"trials/*.mp4\") and text files listing one video per line")
+				("batchJobs", value<int>(), "Number of videos tracked at once with --batch (plugin instances with --sweep), default: half the number of cores")
+				("pluginParameters", value<std::string>(), "Sets parameters of the plugin in --headless mode as Qt properties of the plugin object, e.g. \"threshold=20,minArea=50\"")
+				("sweep", value<std::string>(), "Tracks the video given by --video with the plugin given by --usePlugin once per parameter set, decoding every frame once for all plugin instances, and exits. Takes a grid (e.g. \"threshold=10:40:10,minArea=20|50\") or a text file listing one parameter set per line")
 				;
 
 			options_description gui("GUI options");
@@ -73,6 +91,67 @@ public:
 				auto str = vm["cfg"].as<std::string>();
 				cfg->CfgCustomLocation = QString(str.c_str());
 			}
+			if (vm.count("watch")) {
+				auto str = vm["watch"].as<std::string>();
+				cfg->WatchDirectory = QString(str.c_str());
+			}
+			if (vm.count("pipe")) {
+				auto str = vm["pipe"].as<std::string>();
+				cfg->LoadPipe = QString(str.c_str());
+			}
+			if (vm.count("pipeWidth")) {
+				cfg->PipeWidth = vm["pipeWidth"].as<int>();
+			}
+			if (vm.count("pipeHeight")) {
+				cfg->PipeHeight = vm["pipeHeight"].as<int>();
+			}
+			if (vm.count("pipeFormat")) {
+				auto str = vm["pipeFormat"].as<std::string>();
+				cfg->PipeFormat = QString(str.c_str());
+			}
+			if (vm.count("shm")) {
+				auto str = vm["shm"].as<std::string>();
+				cfg->LoadSharedMemory = QString(str.c_str());
+			}
+			if (vm.count("synthetic")) {
+				auto str = vm["synthetic"].as<std::string>();
+				cfg->LoadSynthetic = QString(str.c_str());
+			}
+			if (vm.count("latencyTrace")) {
+				auto str = vm["latencyTrace"].as<std::string>();
+				cfg->LatencyTrace = QString(str.c_str());
+			}
+			if (vm.count("benchmarkDecode")) {
+				auto str = vm["benchmarkDecode"].as<std::string>();
+				cfg->BenchmarkDecode = QString(str.c_str());
+			}
+			if (vm.count("convertRaw")) {
+				auto str = vm["convertRaw"].as<std::string>();
+				cfg->ConvertRaw = QString(str.c_str());
+			}
+			if (vm.count("headless")) {
+				cfg->Headless = true;
+			}
+			if (vm.count("export")) {
+				auto str = vm["export"].as<std::string>();
+				cfg->ExportPath = QString(str.c_str());
+			}
+			if (vm.count("batch")) {
+				for (auto &str : vm["batch"].as<std::vector<std::string>>()) {
+					cfg->BatchInputs << QString(str.c_str());
+				}
+			}
+			if (vm.count("batchJobs")) {
+				cfg->BatchJobs = vm["batchJobs"].as<int>();
+			}
+			if (vm.count("pluginParameters")) {
+				auto str = vm["pluginParameters"].as<std::string>();
+				cfg->PluginParameters = QString(str.c_str());
+			}
+			if (vm.count("sweep")) {
+				auto str = vm["sweep"].as<std::string>();
+				cfg->SweepSpec = QString(str.c_str());
+			}
 		}
 		catch (std::exception& e) {
 			std::cout << e.what() << "\n";
@@ -85,6 +85,33 @@ void Config::load(QString dir, QString file)
     config->CameraWidth = tree.get<int>(globalPrefix+"CameraWidth",config->CameraWidth);
     config->CameraHeight = tree.get<int>(globalPrefix+"CameraHeight",config->CameraHeight);
     config->GpuQp = tree.get<double>(globalPrefix+"GpuQp",config->GpuQp);
+    config->VideoPrefetchDepth = tree.get<int>(globalPrefix+"VideoPrefetchDepth",config->VideoPrefetchDepth);
+    config->VideoPrefetchMemoryMB = tree.get<int>(globalPrefix+"VideoPrefetchMemoryMB",config->VideoPrefetchMemoryMB);
+    config->VideoSeekIndex = tree.get<int>(globalPrefix+"VideoSeekIndex",config->VideoSeekIndex);
+    config->ReverseChunkFrames = tree.get<int>(globalPrefix+"ReverseChunkFrames",config->ReverseChunkFrames);
+    config->ReverseChunkMB = tree.get<int>(globalPrefix+"ReverseChunkMB",config->ReverseChunkMB);
+    config->FrameCacheMB = tree.get<int>(globalPrefix+"FrameCacheMB",config->FrameCacheMB);
+    config->PicturePrefetchDepth = tree.get<int>(globalPrefix+"PicturePrefetchDepth",config->PicturePrefetchDepth);
+    config->TrackingGrayscale = tree.get<int>(globalPrefix+"TrackingGrayscale",config->TrackingGrayscale);
+    config->DisplayPreview = tree.get<int>(globalPrefix+"DisplayPreview",config->DisplayPreview);
+    config->BatchPreopenFrames = tree.get<int>(globalPrefix+"BatchPreopenFrames",config->BatchPreopenFrames);
+    config->BatchTimeline = tree.get<int>(globalPrefix+"BatchTimeline",config->BatchTimeline);
+    config->WatchBacklog = tree.get<int>(globalPrefix+"WatchBacklog",config->WatchBacklog);
+    config->WatchDropPolicy = tree.get<int>(globalPrefix+"WatchDropPolicy",config->WatchDropPolicy);
+    config->WatchMaxLatencyMs = tree.get<int>(globalPrefix+"WatchMaxLatencyMs",config->WatchMaxLatencyMs);
+    config->WatchTimeoutMs = tree.get<int>(globalPrefix+"WatchTimeoutMs",config->WatchTimeoutMs);
+    config->CompositeSources = tree.get<int>(globalPrefix+"CompositeSources",config->CompositeSources);
+    config->CompositeSync = tree.get<int>(globalPrefix+"CompositeSync",config->CompositeSync);
+    config->CompositeLayout = tree.get<int>(globalPrefix+"CompositeLayout",config->CompositeLayout);
+    config->CaptureRingFrames = tree.get<int>(globalPrefix+"CaptureRingFrames",config->CaptureRingFrames);
+    config->CaptureLossless = tree.get<int>(globalPrefix+"CaptureLossless",config->CaptureLossless);
+    config->VideoBackend = tree.get<int>(globalPrefix+"VideoBackend",config->VideoBackend);
+    config->LibavThreads = tree.get<int>(globalPrefix+"LibavThreads",config->LibavThreads);
+    config->LibavThreadType = tree.get<int>(globalPrefix+"LibavThreadType",config->LibavThreadType);
+    config->LibavGray = tree.get<int>(globalPrefix+"LibavGray",config->LibavGray);
+    config->SharedMemoryCopy = tree.get<int>(globalPrefix+"SharedMemoryCopy",config->SharedMemoryCopy);
+    config->PlayerDirectLoop = tree.get<int>(globalPrefix+"PlayerDirectLoop",config->PlayerDirectLoop);
+    config->TrackingPipelineFrames = tree.get<int>(globalPrefix+"TrackingPipelineFrames",config->TrackingPipelineFrames);
     config->DefaultLocationManualSave = tree.get<QString>(globalPrefix+"DefaultLocationManualSave",config->DefaultLocationManualSave);
     config->DirPlugins = tree.get<QString>(globalPrefix+"DirPlugins",config->DirPlugins);
     config->DirVideos = tree.get<QString>(globalPrefix+"DirVideos",config->DirVideos);
@@ -119,6 +146,33 @@ void Config::save(QString dir, QString file)
     tree.put(globalPrefix+"CameraWidth", config->CameraWidth);
     tree.put(globalPrefix+"CameraHeight", config->CameraHeight);
     tree.put(globalPrefix+"GpuQp", config->GpuQp);
+    tree.put(globalPrefix+"VideoPrefetchDepth", config->VideoPrefetchDepth);
+    tree.put(globalPrefix+"VideoPrefetchMemoryMB", config->VideoPrefetchMemoryMB);
+    tree.put(globalPrefix+"VideoSeekIndex", config->VideoSeekIndex);
+    tree.put(globalPrefix+"ReverseChunkFrames", config->ReverseChunkFrames);
+    tree.put(globalPrefix+"ReverseChunkMB", config->ReverseChunkMB);
+    tree.put(globalPrefix+"FrameCacheMB", config->FrameCacheMB);
+    tree.put(globalPrefix+"PicturePrefetchDepth", config->PicturePrefetchDepth);
+    tree.put(globalPrefix+"TrackingGrayscale", config->TrackingGrayscale);
+    tree.put(globalPrefix+"DisplayPreview", config->DisplayPreview);
+    tree.put(globalPrefix+"BatchPreopenFrames", config->BatchPreopenFrames);
+    tree.put(globalPrefix+"BatchTimeline", config->BatchTimeline);
+    tree.put(globalPrefix+"WatchBacklog", config->WatchBacklog);
+    tree.put(globalPrefix+"WatchDropPolicy", config->WatchDropPolicy);
+    tree.put(globalPrefix+"WatchMaxLatencyMs", config->WatchMaxLatencyMs);
+    tree.put(globalPrefix+"WatchTimeoutMs", config->WatchTimeoutMs);
+    tree.put(globalPrefix+"CompositeSources", config->CompositeSources);
+    tree.put(globalPrefix+"CompositeSync", config->CompositeSync);
+    tree.put(globalPrefix+"CompositeLayout", config->CompositeLayout);
+    tree.put(globalPrefix+"CaptureRingFrames", config->CaptureRingFrames);
+    tree.put(globalPrefix+"CaptureLossless", config->CaptureLossless);
+    tree.put(globalPrefix+"VideoBackend", config->VideoBackend);
+    tree.put(globalPrefix+"LibavThreads", config->LibavThreads);
+    tree.put(globalPrefix+"LibavThreadType", config->LibavThreadType);
+    tree.put(globalPrefix+"LibavGray", config->LibavGray);
+    tree.put(globalPrefix+"SharedMemoryCopy", config->SharedMemoryCopy);
+    tree.put(globalPrefix+"PlayerDirectLoop", config->PlayerDirectLoop);
+    tree.put(globalPrefix+"TrackingPipelineFrames", config->TrackingPipelineFrames);
     tree.put(globalPrefix+"DefaultLocationManualSave", config->DefaultLocationManualSave);
     tree.put(globalPrefix+"DirPlugins", config->DirPlugins);
     tree.put(globalPrefix+"DirVideos", config->DirVideos);
@@ -2,6 +2,7 @@
 
 #include "Utility/IConfig.h"
 #include <QString>
+#include <QStringList>
 #include <map>
 
 class Config : public IConfig
@@ -23,6 +24,33 @@ public:
     int CameraWidth = -1;
     int CameraHeight = -1;
     double GpuQp = 20;
+    int VideoPrefetchDepth = 0;
+    int VideoPrefetchMemoryMB = 512;
+    int VideoSeekIndex = 0;
+    int ReverseChunkFrames = 60;
+    int ReverseChunkMB = 256;
+    int FrameCacheMB = 0;
+    int PicturePrefetchDepth = 0;
+    int TrackingGrayscale = 0;
+    int DisplayPreview = 0;
+    int BatchPreopenFrames = 0;
+    int BatchTimeline = 0;
+    int WatchBacklog = 8;
+    int WatchDropPolicy = 0;
+    int WatchMaxLatencyMs = 0;
+    int WatchTimeoutMs = 1000;
+    int CompositeSources = 0;
+    int CompositeSync = 0;
+    int CompositeLayout = 0;
+    int CaptureRingFrames = 4;
+    int CaptureLossless = 0;
+    int VideoBackend = 0;
+    int LibavThreads = 0;
+    int LibavThreadType = 0;
+    int LibavGray = 0;
+    int SharedMemoryCopy = 0;
+    int PlayerDirectLoop = 0;
+    int TrackingPipelineFrames = 0;
     int UseRegistryLocations = true;
     QString DefaultLocationManualSave = "";
     QString DirPlugins = IConfig::dataLocation + "/Plugins/";
@@ -37,6 +65,22 @@ public:
     QString LoadVideo = "";
     QString UsePlugins = "";
     QString CfgCustomLocation = "";
+    QString ConvertRaw = "";
+    QString LoadSynthetic = "";
+    QString WatchDirectory = "";
+    QString LatencyTrace = "";
+    QString BenchmarkDecode = "";
+    QString LoadPipe = "";
+    QString LoadSharedMemory = "";
+    QString PipeFormat = "bgr24";
+    int PipeWidth = 0;
+    int PipeHeight = 0;
+    bool Headless = false;
+    QString ExportPath = "";
+    QStringList BatchInputs;
+    int BatchJobs = 0;
+    QString PluginParameters = "";
+    QString SweepSpec = "";
 
     void load(QString dir, QString file = "config.ini") override;
     void save(QString dir, QString file) override;